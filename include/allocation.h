@@ -0,0 +1,89 @@
+#ifndef HPORDERBOOK_ALLOCATION_H
+#define HPORDERBOOK_ALLOCATION_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Pro-rata share kernel over SoA resting quantities.
+//
+// shares[i] = floor(fill * quantities[i] / total), exactly. The vector paths compute the
+// quotient in double precision (NEON 2, AVX2 4, SSE2 2 lanes); a scalar pass then checks
+// each share against the 64-bit integer products and corrects the rare off-by-one from
+// rounding, so every platform produces the same shares bit for bit.
+struct ProRata {
+    static void shares(const uint32_t* quantities, size_t count, uint32_t fill, uint32_t total,
+                       uint32_t* shares) noexcept {
+        size_t i = 0;
+        const double fill_d = static_cast<double>(fill);
+        const double total_d = static_cast<double>(total);
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        const float64x2_t fill_v = vdupq_n_f64(fill_d);
+        const float64x2_t total_v = vdupq_n_f64(total_d);
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t q = vcvtq_f64_u64(vmovl_u32(vld1_u32(quantities + i)));
+            float64x2_t share = vrndmq_f64(vdivq_f64(vmulq_f64(q, fill_v), total_v));
+            vst1_u32(shares + i, vmovn_u64(vcvtq_u64_f64(share)));
+        }
+#elif defined(__AVX2__)
+        // Doubles below 2^52 convert to and from integers by adding 2^52 and reading bits
+        const __m256i magic_bits = _mm256_set1_epi64x(0x4330000000000000LL);
+        const __m256d magic = _mm256_castsi256_pd(magic_bits);
+        const __m256d fill_v = _mm256_set1_pd(fill_d);
+        const __m256d total_v = _mm256_set1_pd(total_d);
+        const __m256i low_dwords = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        for (; i + 4 <= count; i += 4) {
+            __m256i wide = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(quantities + i)));
+            __m256d q = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(wide, magic_bits)), magic);
+            __m256d share = _mm256_floor_pd(_mm256_div_pd(_mm256_mul_pd(q, fill_v), total_v));
+            __m256i bits = _mm256_castpd_si256(_mm256_add_pd(share, magic));
+            __m256i packed = _mm256_permutevar8x32_epi32(bits, low_dwords);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(shares + i), _mm256_castsi256_si128(packed));
+        }
+#elif defined(__SSE2__)
+        const __m128i magic_bits = _mm_set1_epi64x(0x4330000000000000LL);
+        const __m128d magic = _mm_castsi128_pd(magic_bits);
+        const __m128d fill_v = _mm_set1_pd(fill_d);
+        const __m128d total_v = _mm_set1_pd(total_d);
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 2 <= count; i += 2) {
+            __m128i wide = _mm_unpacklo_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(quantities + i)), zero);
+            __m128d q = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(wide, magic_bits)), magic);
+            __m128d quotient = _mm_div_pd(_mm_mul_pd(q, fill_v), total_v);
+            // Floor without SSE4.1: round to nearest via 2^52, step back where that rounded up
+            __m128d rounded = _mm_sub_pd(_mm_add_pd(quotient, magic), magic);
+            __m128d share = _mm_sub_pd(rounded, _mm_and_pd(_mm_cmpgt_pd(rounded, quotient), one));
+            __m128i bits = _mm_castpd_si128(_mm_add_pd(share, magic));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(shares + i), _mm_shuffle_epi32(bits, _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+#endif
+        const size_t vector_end = i;
+        for (; i < count; ++i) {
+            shares[i] = static_cast<uint32_t>(static_cast<uint64_t>(fill) * quantities[i] / total);
+        }
+
+        // Exact integer check of the vector lanes
+        for (size_t j = 0; j < vector_end; ++j) {
+            uint64_t exact = static_cast<uint64_t>(fill) * quantities[j];
+            uint64_t share = shares[j];
+            if (share * total > exact) {
+                --share;
+            } else if ((share + 1) * total <= exact) {
+                ++share;
+            }
+            shares[j] = static_cast<uint32_t>(share);
+        }
+    }
+};
+
+#endif //HPORDERBOOK_ALLOCATION_H
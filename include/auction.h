@@ -0,0 +1,73 @@
+#ifndef HPORDERBOOK_AUCTION_H
+#define HPORDERBOOK_AUCTION_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simd_scan.h"
+
+// Outcome of a call auction uncross
+struct AuctionResult {
+    double price = 0;         // equilibrium price; 0 if nothing crosses
+    uint64_t volume = 0;      // quantity executed on each side
+    int64_t imbalance = 0;    // bid minus ask quantity left eligible at `price`
+};
+
+// Equilibrium price search over candidate prices in ascending order, with the bid and
+// ask quantity resting at each (zero where a side has no level).
+//
+// Cumulative curves come from two vector prefix sums: asks executable at candidate i are
+// every ask at or below it, bids every bid at or above it. The equilibrium maximizes
+// executable volume min(bids, asks), then minimizes the absolute imbalance; remaining ties
+// take the middle of the tied candidates. Scratch buffers are reused across calls.
+class AuctionCurves {
+private:
+    std::vector<uint64_t> cumulative_bids_;
+    std::vector<uint64_t> cumulative_asks_;
+
+public:
+    template<typename PriceType>
+    AuctionResult equilibrium(const PriceType* prices, const uint32_t* bid_quantities,
+                              const uint32_t* ask_quantities, size_t count) {
+        AuctionResult result;
+        if (count == 0) return result;
+        cumulative_bids_.resize(count);
+        cumulative_asks_.resize(count);
+        SimdScan::inclusive_scan(bid_quantities, cumulative_bids_.data(), count);
+        SimdScan::inclusive_scan(ask_quantities, cumulative_asks_.data(), count);
+
+        const uint64_t total_bids = cumulative_bids_[count - 1];
+        uint64_t best_volume = 0;
+        uint64_t best_imbalance = 0;
+        size_t first_tie = 0;
+        size_t last_tie = 0;
+        for (size_t i = 0; i < count; ++i) {
+            // Bids at or above prices[i]: everything not strictly below it
+            uint64_t bids = total_bids - cumulative_bids_[i] + bid_quantities[i];
+            uint64_t asks = cumulative_asks_[i];
+            uint64_t volume = bids < asks ? bids : asks;
+            uint64_t imbalance = bids > asks ? bids - asks : asks - bids;
+            if (volume > best_volume || (volume == best_volume && volume > 0 && imbalance < best_imbalance)) {
+                best_volume = volume;
+                best_imbalance = imbalance;
+                first_tie = last_tie = i;
+            } else if (volume == best_volume && volume > 0 && imbalance == best_imbalance) {
+                last_tie = i;
+            }
+        }
+        if (best_volume == 0) return result;
+
+        size_t chosen = first_tie + (last_tie - first_tie) / 2;
+        uint64_t bids = total_bids - cumulative_bids_[chosen] + bid_quantities[chosen];
+        uint64_t asks = cumulative_asks_[chosen];
+        result.price = static_cast<double>(prices[chosen]);
+        result.volume = best_volume;
+        result.imbalance = static_cast<int64_t>(bids) - static_cast<int64_t>(asks);
+        return result;
+    }
+};
+
+#endif //HPORDERBOOK_AUCTION_H
@@ -0,0 +1,95 @@
+#ifndef HPORDERBOOK_BOOK_CONFIG_H
+#define HPORDERBOOK_BOOK_CONFIG_H
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "locks.h"
+
+// Compile-time configuration for OrderBook<PriceType, Config>.
+//
+// A config is a struct of static constexpr members; derive from DefaultBookConfig and
+// shadow the members to change. Every choice is resolved with if constexpr or a type
+// alias, so an unused feature costs nothing at run time.
+
+enum class LockPolicy {
+    NONE,           // single-threaded: no synchronization at all
+    SPINLOCK,       // TTAS with backoff: short critical sections, few writers
+    TICKET,         // FIFO ticket lock: fair under sustained contention
+    MCS,            // queue lock: each waiter spins on its own cache line
+    SHARED_MUTEX    // std::shared_mutex: concurrent readers
+};
+
+enum class LevelStorage {
+    MAP,            // std::pmr::map on the book's node pool
+    LADDER,         // HybridLevels: tick window around the touch plus sparse outliers
+    BTREE,          // BPlusTree with cache-line nodes, on the book's node pool
+    SOA_LADDER      // PriceLevelStore: aggregate levels in parallel arrays over a fixed band
+};
+
+enum class OrderTracking {
+    AGGREGATE,      // quantity and order count per level only
+    PER_ORDER       // every resting order kept in a FIFO per level
+};
+
+enum class Allocation {
+    FIFO,           // price-time priority
+    PRO_RATA,       // a partially consumed level is shared in proportion to resting size
+    FIFO_PRO_RATA   // the oldest order fills first, the rest of the fill is pro-rata
+};
+
+enum class SelfTradePrevention {
+    NONE,           // orders of one account may trade with each other
+    CANCEL_OLDEST,  // cancel the resting order and keep matching
+    CANCEL_NEWEST,  // cancel the rest of the aggressor
+    DECREMENT_BOTH  // reduce both by the smaller quantity, without a trade
+};
+
+enum class FillOutput {
+    VECTOR,         // process_market_order returns std::vector<MatchResult>
+    SINK            // fills only go to a caller-supplied sink; nothing is allocated
+};
+
+struct DefaultBookConfig {
+    static constexpr LockPolicy lock_policy = LockPolicy::SHARED_MUTEX;
+    static constexpr LevelStorage level_storage = LevelStorage::MAP;
+    static constexpr OrderTracking order_tracking = OrderTracking::AGGREGATE;
+    static constexpr FillOutput fill_output = FillOutput::VECTOR;
+    static constexpr size_t queue_capacity = size_t{1} << 20;  // power of two
+    static constexpr size_t batch_width = 4;                   // orders per vector update
+    static constexpr double tick_size = 0.01;                  // LADDER and SOA_LADDER only
+    static constexpr size_t ladder_ticks = 4096;               // LADDER window / SOA_LADDER band width
+    static constexpr double ladder_base_price = 0.0;           // SOA_LADDER: price of the band's first tick
+    static constexpr bool flat_combining = false;              // batch concurrent add_limit_order calls
+    static constexpr size_t combining_slots = 64;              // publication slots when combining
+    static constexpr bool l2_feed = false;                     // publish L2 updates to a broadcast ring
+    static constexpr size_t l2_feed_capacity = size_t{1} << 16;  // power of two
+    static constexpr bool l3_feed = false;                     // per-order books: publish order events
+    static constexpr size_t l3_feed_capacity = size_t{1} << 16;  // power of two
+    static constexpr bool depth_views = false;                 // RCU depth views for lock-free readers
+    static constexpr size_t depth_view_readers = 64;           // registered view readers at most
+    static constexpr size_t l3_view_readers = 16;              // per-order books: concurrent l3_snapshot calls
+    static constexpr bool stop_orders = false;                 // stop and stop-limit orders (index not pooled)
+    static constexpr Allocation allocation = Allocation::FIFO;  // per-order books
+    static constexpr uint32_t pro_rata_min_allocation = 1;     // smaller shares go to the FIFO remainder
+    static constexpr SelfTradePrevention self_trade_prevention = SelfTradePrevention::NONE;  // per-order books
+};
+
+// One matching thread, no locking, per-order queues on a tick ladder, fills to a sink
+struct BacktestBookConfig : DefaultBookConfig {
+    static constexpr LockPolicy lock_policy = LockPolicy::NONE;
+    static constexpr LevelStorage level_storage = LevelStorage::LADDER;
+    static constexpr OrderTracking order_tracking = OrderTracking::PER_ORDER;
+    static constexpr FillOutput fill_output = FillOutput::SINK;
+    static constexpr size_t queue_capacity = 1024;
+};
+
+template<LockPolicy P>
+using BookLock = std::conditional_t<P == LockPolicy::NONE, NullLock,
+                 std::conditional_t<P == LockPolicy::SPINLOCK, SpinLock,
+                 std::conditional_t<P == LockPolicy::TICKET, TicketLock,
+                 std::conditional_t<P == LockPolicy::MCS, McsLock, PaddedSharedMutex>>>>;
+
+#endif //HPORDERBOOK_BOOK_CONFIG_H
@@ -0,0 +1,361 @@
+#ifndef HPORDERBOOK_BPLUS_TREE_H
+#define HPORDERBOOK_BPLUS_TREE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "order_types.h"
+
+// Cache-conscious ordered map: a B+tree whose nodes are 64-byte aligned and hold NodeKeys
+// keys in one contiguous array, so a node search is a branch-free linear pass over one or
+// two cache lines instead of a pointer chase per comparison. Leaves are linked for in-order
+// iteration. Erase removes empty nodes but does not rebalance underfull ones; separators
+// stay valid lower bounds, which keeps erase cheap on the matching path. Nodes come from a
+// std::pmr::memory_resource, e.g. a NodePool with NODE_SIZE blocks aligned to NODE_ALIGN.
+template<typename K, typename V, typename Compare = std::less<K>, size_t NodeKeys = 16>
+class BPlusTree {
+    static_assert(NodeKeys >= 4 && NodeKeys <= 64, "NodeKeys out of range");
+
+private:
+    struct Node {
+        uint16_t count;  // keys held
+        bool is_leaf;
+    };
+
+    struct alignas(64) Leaf : Node {
+        K keys[NodeKeys];
+        V values[NodeKeys];
+        Leaf* prev;
+        Leaf* next;
+    };
+
+    // children[i] holds keys k with keys[i-1] <= k < keys[i]; count + 1 children
+    struct alignas(64) Inner : Node {
+        K keys[NodeKeys];
+        Node* children[NodeKeys + 1];
+    };
+
+    struct InsertResult {
+        V* value;
+        bool inserted;
+        Node* split;     // new right sibling, if the node split
+        K split_key;     // smallest key reachable through `split`
+    };
+
+    std::pmr::memory_resource* resource_;
+    Node* root_;
+    Leaf* first_leaf_;
+    size_t size_ = 0;
+    Compare comp_;
+
+    // Leaves and inner nodes share one allocation size, so a pool needs one block size
+    void* allocate_node() { return resource_->allocate(NODE_SIZE, NODE_ALIGN); }
+
+    Leaf* new_leaf() {
+        Leaf* leaf = ::new (allocate_node()) Leaf;
+        leaf->count = 0;
+        leaf->is_leaf = true;
+        leaf->prev = leaf->next = nullptr;
+        return leaf;
+    }
+
+    Inner* new_inner() {
+        Inner* inner = ::new (allocate_node()) Inner;
+        inner->count = 0;
+        inner->is_leaf = false;
+        return inner;
+    }
+
+    template<typename T>
+    void delete_node(T* node) {
+        node->~T();
+        resource_->deallocate(node, NODE_SIZE, NODE_ALIGN);
+    }
+
+    // Number of keys ordered before k: the insertion point in a leaf
+    size_t leaf_position(const Leaf* leaf, const K& k) const noexcept {
+        size_t pos = 0;
+        for (size_t i = 0; i < leaf->count; ++i) pos += comp_(leaf->keys[i], k);
+        return pos;
+    }
+
+    // Number of separators <= k: the child to descend into
+    size_t child_index(const Inner* inner, const K& k) const noexcept {
+        size_t idx = 0;
+        for (size_t i = 0; i < inner->count; ++i) idx += !comp_(k, inner->keys[i]);
+        return idx;
+    }
+
+    InsertResult insert_leaf(Leaf* leaf, const K& k, const V& v) {
+        size_t pos = leaf_position(leaf, k);
+        if (pos < leaf->count && !comp_(k, leaf->keys[pos])) {
+            return {&leaf->values[pos], false, nullptr, K{}};
+        }
+
+        Leaf* target = leaf;
+        Leaf* split = nullptr;
+        if (leaf->count == NodeKeys) {
+            split = new_leaf();
+            size_t keep = NodeKeys / 2;
+            split->count = static_cast<uint16_t>(NodeKeys - keep);
+            for (size_t i = 0; i < split->count; ++i) {
+                split->keys[i] = leaf->keys[keep + i];
+                split->values[i] = leaf->values[keep + i];
+            }
+            leaf->count = static_cast<uint16_t>(keep);
+            split->next = leaf->next;
+            split->prev = leaf;
+            if (leaf->next) leaf->next->prev = split;
+            leaf->next = split;
+            if (pos > keep) {
+                target = split;
+                pos -= keep;
+            }
+        }
+
+        for (size_t i = target->count; i > pos; --i) {
+            target->keys[i] = target->keys[i - 1];
+            target->values[i] = target->values[i - 1];
+        }
+        target->keys[pos] = k;
+        target->values[pos] = v;
+        ++target->count;
+        ++size_;
+        return {&target->values[pos], true, split, split ? split->keys[0] : K{}};
+    }
+
+    InsertResult insert_node(Node* node, const K& k, const V& v) {
+        if (node->is_leaf) return insert_leaf(static_cast<Leaf*>(node), k, v);
+
+        auto* inner = static_cast<Inner*>(node);
+        size_t idx = child_index(inner, k);
+        InsertResult result = insert_node(inner->children[idx], k, v);
+        if (!result.split) return result;
+
+        if (inner->count < NodeKeys) {
+            for (size_t i = inner->count; i > idx; --i) {
+                inner->keys[i] = inner->keys[i - 1];
+                inner->children[i + 1] = inner->children[i];
+            }
+            inner->keys[idx] = result.split_key;
+            inner->children[idx + 1] = result.split;
+            ++inner->count;
+            result.split = nullptr;
+            return result;
+        }
+
+        // Full inner node: lay out NodeKeys + 1 separators, keep the lower half, promote the middle
+        K keys[NodeKeys + 1];
+        Node* children[NodeKeys + 2];
+        for (size_t i = 0, j = 0; i <= NodeKeys; ++i) {
+            keys[i] = (i == idx) ? result.split_key : inner->keys[j++];
+        }
+        for (size_t i = 0, j = 0; i <= NodeKeys + 1; ++i) {
+            children[i] = (i == idx + 1) ? result.split : inner->children[j++];
+        }
+
+        size_t mid = (NodeKeys + 1) / 2;
+        Inner* right = new_inner();
+        inner->count = static_cast<uint16_t>(mid);
+        for (size_t i = 0; i < mid; ++i) inner->keys[i] = keys[i];
+        for (size_t i = 0; i <= mid; ++i) inner->children[i] = children[i];
+        right->count = static_cast<uint16_t>(NodeKeys - mid);
+        for (size_t i = 0; i < right->count; ++i) right->keys[i] = keys[mid + 1 + i];
+        for (size_t i = 0; i <= right->count; ++i) right->children[i] = children[mid + 1 + i];
+
+        result.split = right;
+        result.split_key = keys[mid];
+        return result;
+    }
+
+    // Returns true if `node` is left empty and should be removed by its parent
+    bool erase_node(Node* node, const K& k, bool& erased) {
+        if (node->is_leaf) {
+            auto* leaf = static_cast<Leaf*>(node);
+            size_t pos = leaf_position(leaf, k);
+            if (pos == leaf->count || comp_(k, leaf->keys[pos])) return false;
+            for (size_t i = pos + 1; i < leaf->count; ++i) {
+                leaf->keys[i - 1] = leaf->keys[i];
+                leaf->values[i - 1] = leaf->values[i];
+            }
+            --leaf->count;
+            --size_;
+            erased = true;
+            return leaf->count == 0;
+        }
+
+        auto* inner = static_cast<Inner*>(node);
+        size_t idx = child_index(inner, k);
+        if (!erase_node(inner->children[idx], k, erased)) return false;
+
+        free_node(inner->children[idx]);
+        if (inner->count == 0) return true;  // that was the only child
+        // Drop the child and the separator bounding it (its left one, or the first)
+        size_t key_pos = idx > 0 ? idx - 1 : 0;
+        for (size_t i = key_pos + 1; i < inner->count; ++i) inner->keys[i - 1] = inner->keys[i];
+        for (size_t i = idx + 1; i <= inner->count; ++i) inner->children[i - 1] = inner->children[i];
+        --inner->count;
+        return false;
+    }
+
+    void free_node(Node* node) {
+        if (node->is_leaf) {
+            auto* leaf = static_cast<Leaf*>(node);
+            if (leaf->prev) leaf->prev->next = leaf->next;
+            if (leaf->next) leaf->next->prev = leaf->prev;
+            if (leaf == first_leaf_) first_leaf_ = leaf->next;
+            delete_node(leaf);
+        } else {
+            delete_node(static_cast<Inner*>(node));
+        }
+    }
+
+    void destroy(Node* node) {
+        if (node->is_leaf) {
+            delete_node(static_cast<Leaf*>(node));
+            return;
+        }
+        auto* inner = static_cast<Inner*>(node);
+        for (size_t i = 0; i <= inner->count; ++i) destroy(inner->children[i]);
+        delete_node(inner);
+    }
+
+    const Leaf* find_leaf(const K& k) const noexcept {
+        const Node* node = root_;
+        while (!node->is_leaf) {
+            auto* inner = static_cast<const Inner*>(node);
+            node = inner->children[child_index(inner, k)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+public:
+    static constexpr size_t NODE_SIZE = std::max(sizeof(Leaf), sizeof(Inner));
+    static constexpr size_t NODE_ALIGN = alignof(Leaf);
+
+    class const_iterator {
+        friend class BPlusTree;
+        const Leaf* leaf_ = nullptr;
+        size_t index_ = 0;
+
+        const_iterator(const Leaf* leaf, size_t index) : leaf_(leaf), index_(index) {
+            normalize();
+        }
+
+        void normalize() noexcept {
+            while (leaf_ && index_ >= leaf_->count) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+        }
+
+    public:
+        const_iterator() = default;
+        const K& key() const noexcept { return leaf_->keys[index_]; }
+        const V& value() const noexcept { return leaf_->values[index_]; }
+        const_iterator& operator++() noexcept {
+            ++index_;
+            normalize();
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const noexcept {
+            return leaf_ == other.leaf_ && (leaf_ == nullptr || index_ == other.index_);
+        }
+        bool operator!=(const const_iterator& other) const noexcept { return !(*this == other); }
+    };
+
+    explicit BPlusTree(std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+            : resource_(resource), root_(new_leaf()) {
+        first_leaf_ = static_cast<Leaf*>(root_);
+    }
+
+    ~BPlusTree() { destroy(root_); }
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const_iterator begin() const noexcept { return const_iterator(first_leaf_, 0); }
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    // First entry not ordered before k
+    const_iterator lower_bound(const K& k) const noexcept {
+        const Leaf* leaf = find_leaf(k);
+        return const_iterator(leaf, leaf_position(leaf, k));
+    }
+
+    V* find(const K& k) noexcept {
+        auto* leaf = const_cast<Leaf*>(find_leaf(k));
+        size_t pos = leaf_position(leaf, k);
+        if (pos < leaf->count && !comp_(k, leaf->keys[pos])) return &leaf->values[pos];
+        return nullptr;
+    }
+
+    std::pair<V*, bool> try_emplace(const K& k, const V& v) {
+        InsertResult result = insert_node(root_, k, v);
+        if (result.split) {
+            Inner* root = new_inner();
+            root->count = 1;
+            root->keys[0] = result.split_key;
+            root->children[0] = root_;
+            root->children[1] = result.split;
+            root_ = root;
+        }
+        return {result.value, result.inserted};
+    }
+
+    bool erase(const K& k) {
+        bool erased = false;
+        if (erase_node(root_, k, erased) && !root_->is_leaf) {
+            free_node(root_);
+            root_ = first_leaf_ = new_leaf();
+        }
+        // Collapse single-child roots
+        while (!root_->is_leaf && static_cast<Inner*>(root_)->count == 0) {
+            Node* child = static_cast<Inner*>(root_)->children[0];
+            delete_node(static_cast<Inner*>(root_));
+            root_ = child;
+        }
+        return erased;
+    }
+
+    // Price level container interface (see HybridLevels): best level first.
+    // Splits move values between nodes, so references do not survive an insert.
+    static constexpr bool STABLE_REFERENCES = false;
+
+    V& find_or_insert(const K& k) { return *try_emplace(k, V{}).first; }
+
+    V* best(K& key) noexcept {
+        if (empty()) return nullptr;
+        Leaf* leaf = first_leaf_;
+        while (leaf->count == 0) leaf = leaf->next;
+        key = leaf->keys[0];
+        return &leaf->values[0];
+    }
+
+    const V* best(K& key) const noexcept {
+        return const_cast<BPlusTree*>(this)->best(key);
+    }
+
+    template<typename F>
+    void for_each(F&& f) const {
+        for (auto it = begin(); it != end(); ++it) {
+            if (!f(it.key(), it.value())) return;
+        }
+    }
+};
+
+// Price levels for one side of the book, best price at begin()
+template<typename PriceType, Side S, typename Level = PriceLevel>
+using BTreeLevels = BPlusTree<PriceType, Level, SidePriority<S>>;
+
+#endif //HPORDERBOOK_BPLUS_TREE_H
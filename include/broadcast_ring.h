@@ -0,0 +1,109 @@
+#ifndef HPORDERBOOK_BROADCAST_RING_H
+#define HPORDERBOOK_BROADCAST_RING_H
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "locks.h"
+
+// Single-producer, multi-consumer broadcast ring. The producer never waits: it overwrites
+// the oldest entry when the ring is full. Each consumer owns a Reader cursor and reads at
+// its own pace; a reader that falls a full ring behind is told how many entries it lost
+// and resumes from the oldest entry still available.
+//
+// Every slot carries a seqlock word: 2c + 1 while entry c is being written, 2c + 2 once it
+// is complete. A reader copies the value between two loads of that word and retries if
+// they differ, so there are no locks and no read-side writes to shared lines.
+template<typename T, size_t N>
+class BroadcastRing {
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    static constexpr size_t MASK = N - 1;
+
+    struct Slot {
+        std::atomic<uint64_t> version{0};
+        T value;
+    };
+
+    std::vector<Slot> slots_;
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};   // entries ever published
+
+public:
+    enum class ReadStatus { OK, EMPTY, LAPPED };
+
+    class Reader {
+        friend class BroadcastRing;
+        const BroadcastRing* ring_;
+        uint64_t cursor_;
+
+        Reader(const BroadcastRing* ring, uint64_t cursor) : ring_(ring), cursor_(cursor) {}
+
+    public:
+        // Next entry in publication order. LAPPED means entries were overwritten before
+        // this reader got to them; `lost` says how many, and the next poll resumes at the
+        // oldest entry still in the ring.
+        ReadStatus poll(T& out, uint64_t* lost = nullptr) noexcept {
+            const Slot& slot = ring_->slots_[cursor_ & MASK];
+            uint64_t ready = 2 * cursor_ + 2;
+            for (;;) {
+                uint64_t before = slot.version.load(std::memory_order_acquire);
+                if (before < ready) return ReadStatus::EMPTY;
+                if (before == ready) {
+                    out = slot.value;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (slot.version.load(std::memory_order_relaxed) == before) {
+                        ++cursor_;
+                        return ReadStatus::OK;
+                    }
+                    continue;  // overwritten while copying
+                }
+                // Entry `head` may be mid-write over head - N, so resume one past that
+                uint64_t head = ring_->head_.load(std::memory_order_acquire);
+                uint64_t oldest = head >= N ? head - N + 1 : 0;
+                if (lost) *lost = oldest - cursor_;
+                cursor_ = oldest;
+                return ReadStatus::LAPPED;
+            }
+        }
+
+        uint64_t position() const noexcept { return cursor_; }
+    };
+
+    BroadcastRing() : slots_(N) {}
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    static constexpr size_t capacity() noexcept { return N; }
+
+    // Producer only
+    void publish(const T& value) noexcept {
+        uint64_t index = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[index & MASK];
+        slot.version.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = value;
+        slot.version.store(2 * index + 2, std::memory_order_release);
+        head_.store(index + 1, std::memory_order_release);
+    }
+
+    uint64_t published() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    // A reader that sees only entries published from now on
+    Reader reader() const noexcept { return Reader(this, published()); }
+
+    // A reader positioned at the oldest entry still in the ring
+    Reader reader_from_oldest() const noexcept {
+        uint64_t head = published();
+        return Reader(this, head > N ? head - N : 0);
+    }
+};
+
+#endif //HPORDERBOOK_BROADCAST_RING_H
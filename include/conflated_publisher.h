@@ -0,0 +1,224 @@
+#ifndef HPORDERBOOK_CONFLATED_PUBLISHER_H
+#define HPORDERBOOK_CONFLATED_PUBLISHER_H
+
+#pragma once
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "level_bitmap.h"
+#include "market_data.h"
+
+// Conflating stage between a book's L2 feed and slow subscribers. poll() drains the feed
+// into a table holding the latest state of each level; publish() hands each subscriber
+// whose interval has elapsed the levels that changed since its last tick, once each,
+// however many updates arrived in between.
+//
+// Memory is fixed at construction: MaxLevels level states, a hash index over them, and one
+// dirty bitmap per subscriber. A removed level keeps its slot until every subscriber has
+// been sent the removal. Updates for new levels beyond MaxLevels are counted in dropped().
+//
+// Runs on its own thread and reads the feed lock-free, so the matching thread never waits
+// for it. The one exception is recovery: if the feed laps this reader, the table is rebuilt
+// from get_depth(), which takes the book's read lock once. Not synchronized otherwise.
+template<typename Book, size_t MaxLevels = 4096>
+class ConflatedPublisher {
+    static_assert(MaxLevels > 0 && MaxLevels < UINT32_MAX, "MaxLevels out of range");
+
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void(const L2Update&)>;
+
+private:
+    using Feed = typename Book::L2Feed;
+
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr size_t INDEX_SIZE = std::bit_ceil(MaxLevels * 2);
+    static constexpr size_t MASK = INDEX_SIZE - 1;
+
+    struct LevelState {
+        L2Update state;
+        uint32_t pending;   // subscribers that have not been sent `state` yet
+    };
+
+    struct Subscriber {
+        Callback deliver;
+        Clock::duration interval;
+        Clock::time_point next_due;
+        LevelBitmap dirty;  // slots changed since this subscriber's last tick
+    };
+
+    const Book& book_;
+    typename Feed::Reader reader_;
+    std::vector<LevelState> levels_;
+    std::vector<uint32_t> free_;    // unused slots
+    std::vector<uint32_t> index_;   // open addressing over (price, side) -> slot
+    std::vector<Subscriber> subscribers_;
+    uint64_t lost_ = 0;
+    uint64_t dropped_ = 0;
+
+    static size_t hash(double price, Side side) noexcept {
+        uint64_t h = (std::bit_cast<uint64_t>(price) ^ static_cast<uint64_t>(side)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    // Index position holding the level, or the empty position where it would go
+    size_t probe(double price, Side side) const noexcept {
+        size_t pos = hash(price, side) & MASK;
+        while (index_[pos] != EMPTY) {
+            const L2Update& state = levels_[index_[pos]].state;
+            if (state.price == price && state.side == side) break;
+            pos = (pos + 1) & MASK;
+        }
+        return pos;
+    }
+
+    // Free a slot and close the gap in its probe sequence by shifting entries back
+    void release(uint32_t slot) noexcept {
+        size_t hole = probe(levels_[slot].state.price, levels_[slot].state.side);
+        for (size_t pos = (hole + 1) & MASK; index_[pos] != EMPTY; pos = (pos + 1) & MASK) {
+            const L2Update& state = levels_[index_[pos]].state;
+            size_t home = hash(state.price, state.side) & MASK;
+            if (((pos - home) & MASK) >= ((pos - hole) & MASK)) {
+                index_[hole] = index_[pos];
+                hole = pos;
+            }
+        }
+        index_[hole] = EMPTY;
+        free_.push_back(slot);
+    }
+
+    void mark_dirty(uint32_t slot) noexcept {
+        for (auto& subscriber : subscribers_) {
+            if (!subscriber.dirty.test(slot)) {
+                subscriber.dirty.set(slot);
+                ++levels_[slot].pending;
+            }
+        }
+    }
+
+    void apply(const L2Update& update) {
+        size_t pos = probe(update.price, update.side);
+        uint32_t slot = index_[pos];
+        if (slot == EMPTY) {
+            if (update.quantity == 0) return;   // already sent to everyone, or never tracked
+            if (free_.empty()) {
+                ++dropped_;
+                return;
+            }
+            slot = free_.back();
+            free_.pop_back();
+            index_[pos] = slot;
+            levels_[slot].pending = 0;
+        }
+        levels_[slot].state = update;
+        mark_dirty(slot);
+        if (update.quantity == 0 && levels_[slot].pending == 0) release(slot);
+    }
+
+    // Rebuild from the book after losing feed entries. Every tracked level is marked
+    // removed, then the book's depth is applied over it; levels still present simply
+    // overwrite their removal before the next tick.
+    void resync() {
+        reader_ = book_.l2_feed().reader();
+        std::vector<uint32_t> live;
+        for (uint32_t slot : index_) {
+            if (slot != EMPTY && levels_[slot].state.quantity != 0) live.push_back(slot);
+        }
+        for (uint32_t slot : live) {
+            L2Update removed = levels_[slot].state;
+            removed.quantity = 0;
+            removed.order_count = 0;
+            apply(removed);
+        }
+
+        uint64_t sequence = book_.last_sequence();
+        for (Side side : {Side::BUY, Side::SELL}) {
+            for (const DepthLevel& level : book_.get_depth(side, MaxLevels)) {
+                L2Update update{};
+                update.price = level.price;
+                update.sequence = sequence;
+                update.quantity = level.total_quantity;
+                update.order_count = level.order_count;
+                update.side = side;
+                apply(update);
+            }
+        }
+    }
+
+public:
+    explicit ConflatedPublisher(const Book& book)
+            : book_(book), reader_(book.l2_feed().reader()), levels_(MaxLevels), index_(INDEX_SIZE, EMPTY) {
+        free_.reserve(MaxLevels);
+        for (size_t slot = MaxLevels; slot-- > 0;) free_.push_back(static_cast<uint32_t>(slot));
+    }
+
+    ConflatedPublisher(const ConflatedPublisher&) = delete;
+    ConflatedPublisher& operator=(const ConflatedPublisher&) = delete;
+
+    // Add a subscriber that receives at most one batch per `min_interval`. It is first
+    // sent every level currently tracked. Returns the number of subscribers.
+    size_t subscribe(Callback deliver, Clock::duration min_interval = Clock::duration::zero()) {
+        subscribers_.push_back(Subscriber{std::move(deliver), min_interval, Clock::time_point{},
+                                          LevelBitmap(MaxLevels)});
+        Subscriber& subscriber = subscribers_.back();
+        for (uint32_t slot : index_) {
+            if (slot != EMPTY && levels_[slot].state.quantity != 0) {
+                subscriber.dirty.set(slot);
+                ++levels_[slot].pending;
+            }
+        }
+        return subscribers_.size();
+    }
+
+    // Drain the feed into the level table; at most one ring's worth per call so a busy
+    // producer cannot keep this stage from publishing. Returns the updates applied.
+    size_t poll() {
+        size_t applied = 0;
+        L2Update update;
+        uint64_t lost = 0;
+        while (applied < Feed::capacity()) {
+            auto status = reader_.poll(update, &lost);
+            if (status == Feed::ReadStatus::EMPTY) break;
+            if (status == Feed::ReadStatus::LAPPED) {
+                lost_ += lost;
+                resync();
+                continue;
+            }
+            apply(update);
+            ++applied;
+        }
+        return applied;
+    }
+
+    // Send each due subscriber the latest state of every level it has not seen, in slot
+    // order; a quantity of zero is a removal. Returns the updates delivered.
+    size_t publish(Clock::time_point now = Clock::now()) {
+        size_t delivered = 0;
+        for (auto& subscriber : subscribers_) {
+            if (now < subscriber.next_due || !subscriber.dirty.any()) continue;
+            subscriber.next_due = now + subscriber.interval;
+            for (size_t slot = subscriber.dirty.first(); slot != LevelBitmap::NPOS;
+                 slot = subscriber.dirty.next_set(slot + 1)) {
+                subscriber.dirty.clear(slot);
+                LevelState& level = levels_[slot];
+                subscriber.deliver(level.state);
+                ++delivered;
+                if (--level.pending == 0 && level.state.quantity == 0) {
+                    release(static_cast<uint32_t>(slot));
+                }
+            }
+        }
+        return delivered;
+    }
+
+    size_t tracked_levels() const noexcept { return MaxLevels - free_.size(); }
+    uint64_t lost() const noexcept { return lost_; }         // feed entries skipped by resyncs
+    uint64_t dropped() const noexcept { return dropped_; }   // new levels beyond MaxLevels
+};
+
+#endif //HPORDERBOOK_CONFLATED_PUBLISHER_H
@@ -0,0 +1,73 @@
+#ifndef HPORDERBOOK_DEPTH_VIEW_H
+#define HPORDERBOOK_DEPTH_VIEW_H
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "epoch.h"
+#include "order_types.h"
+#include "order_store.h"
+
+// Immutable depth of both sides, best level first, as of one sequence number
+struct DepthView {
+    uint64_t sequence = 0;
+    std::vector<DepthLevel> bids;
+    std::vector<DepthLevel> asks;
+};
+
+// Immutable copy of every resting order (per-order books), bids then asks, best level
+// first and in time priority within a level, as of one sequence number
+struct L3View {
+    uint64_t sequence = 0;
+    std::vector<RestingOrder> orders;
+};
+
+// Read-copy-update holder for immutable views of the book. A publisher builds a complete
+// new view and swaps it in with one pointer store; readers pin, load the pointer and walk
+// the view with no lock, for as long as they like. Replaced views are retired to an
+// EpochDomain and freed once no pinned reader can still hold them.
+template<typename View, size_t MaxReaders = 64>
+class ViewPublisher {
+public:
+    using Domain = EpochDomain<MaxReaders>;
+
+private:
+    Domain epochs_;
+    std::atomic<const View*> current_{nullptr};
+    std::mutex publish_mutex_;   // publishers are serialized; readers never take it
+
+public:
+    ViewPublisher() = default;
+    ViewPublisher(const ViewPublisher&) = delete;
+    ViewPublisher& operator=(const ViewPublisher&) = delete;
+
+    ~ViewPublisher() { delete current_.load(std::memory_order_relaxed); }
+
+    typename Domain::Reader reader() noexcept { return epochs_.register_reader(); }
+    std::optional<typename Domain::Reader> try_reader() noexcept { return epochs_.try_register_reader(); }
+
+    // Latest view, or nullptr before the first publish. Only dereference it while holding
+    // a guard from reader().pin() taken before this call.
+    const View* current() const noexcept { return current_.load(std::memory_order_acquire); }
+
+    // Swap in `view`, then free the replaced views no pinned reader can still hold, so at
+    // most the views in use stay alive
+    void publish(std::unique_ptr<View> view) {
+        std::lock_guard lock(publish_mutex_);
+        const View* old = current_.exchange(view.release(), std::memory_order_acq_rel);
+        if (old) epochs_.retire(const_cast<View*>(old));
+        epochs_.reclaim();
+    }
+};
+
+template<size_t MaxReaders = 64>
+using DepthViewPublisher = ViewPublisher<DepthView, MaxReaders>;
+
+#endif //HPORDERBOOK_DEPTH_VIEW_H
@@ -0,0 +1,161 @@
+#ifndef HPORDERBOOK_EPOCH_H
+#define HPORDERBOOK_EPOCH_H
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "locks.h"
+
+// Epoch-based reclamation for structures that readers traverse without a lock.
+//
+// The single writer unlinks an object, then retire()s it; the object is freed only once
+// no reader can still hold it. Each reader registers once and pins the current epoch for
+// the duration of a traversal. Every retire stamps the object with the epoch and advances
+// it, so an object retired at epoch e is safe to free when every pinned reader has an
+// epoch above e: such readers pinned after the unlink and can no longer reach it.
+//
+// Pinning is one store and one fence to the reader's own cache line; readers never write
+// shared state. A reader that stays pinned holds back reclamation, not the writer.
+// retire() and reclaim() must be called by one thread at a time (the book's writer).
+template<size_t MaxReaders = 64>
+class EpochDomain {
+    static_assert(MaxReaders > 0, "MaxReaders must be positive");
+
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+    static constexpr size_t RECLAIM_BATCH = 64;   // retires between automatic reclaims
+
+    struct alignas(CACHE_LINE) Participant {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> claimed{false};
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    std::array<Participant, MaxReaders> participants_;
+    alignas(CACHE_LINE) std::atomic<uint64_t> epoch_{0};
+    std::vector<Retired> retired_;   // writer only, in epoch order
+
+public:
+    class Reader;
+
+    // Pinned for its lifetime; objects reachable while pinned stay valid until it ends
+    class Guard {
+        friend class Reader;
+        Participant* participant_;
+
+        explicit Guard(Participant* participant) noexcept : participant_(participant) {}
+
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() { participant_->epoch.store(IDLE, std::memory_order_release); }
+    };
+
+    // One registered reader slot; owned by a single thread. Pins do not nest.
+    class Reader {
+        friend class EpochDomain;
+        EpochDomain* domain_;
+        Participant* participant_;
+
+        Reader(EpochDomain* domain, Participant* participant) noexcept
+                : domain_(domain), participant_(participant) {}
+
+    public:
+        Reader(Reader&& other) noexcept : domain_(other.domain_), participant_(other.participant_) {
+            other.participant_ = nullptr;
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader&&) = delete;
+
+        ~Reader() {
+            if (participant_) participant_->claimed.store(false, std::memory_order_release);
+        }
+
+        [[nodiscard]] Guard pin() noexcept {
+            participant_->epoch.store(domain_->epoch_.load(std::memory_order_acquire),
+                                      std::memory_order_relaxed);
+            // Publish the pin before any load of the protected structure
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return Guard(participant_);
+        }
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Frees everything still retired; no reader may be pinned
+    ~EpochDomain() {
+        for (const Retired& retired : retired_) retired.deleter(retired.object);
+    }
+
+    // Claim a reader slot, or nullopt if all MaxReaders slots are taken
+    std::optional<Reader> try_register_reader() noexcept {
+        for (auto& participant : participants_) {
+            bool expected = false;
+            if (!participant.claimed.load(std::memory_order_relaxed) &&
+                participant.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire,
+                                                            std::memory_order_relaxed)) {
+                return Reader(this, &participant);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Claim a reader slot. Spins while all MaxReaders slots are taken, so a caller that
+    // may already hold one (or compete with more than MaxReaders others) should use
+    // try_register_reader() and fall back instead.
+    Reader register_reader() noexcept {
+        SpinWait wait;
+        for (;;) {
+            if (auto reader = try_register_reader()) return std::move(*reader);
+            wait();
+        }
+    }
+
+    // Defer deleter(object) until no reader can hold it. The object must already be
+    // unreachable for readers that pin from now on.
+    void retire(void* object, void (*deleter)(void*)) {
+        uint64_t epoch = epoch_.fetch_add(1, std::memory_order_acq_rel);
+        retired_.push_back(Retired{object, deleter, epoch});
+        if (retired_.size() % RECLAIM_BATCH == 0) reclaim();
+    }
+
+    template<typename T>
+    void retire(T* object) {
+        retire(object, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // Free every retired object older than the oldest pinned reader. Returns the count.
+    size_t reclaim() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t safe = epoch_.load(std::memory_order_relaxed);
+        for (const auto& participant : participants_) {
+            uint64_t epoch = participant.epoch.load(std::memory_order_acquire);
+            if (epoch < safe) safe = epoch;
+        }
+        size_t freed = 0;
+        while (freed < retired_.size() && retired_[freed].epoch < safe) {
+            retired_[freed].deleter(retired_[freed].object);
+            ++freed;
+        }
+        retired_.erase(retired_.begin(), retired_.begin() + static_cast<std::ptrdiff_t>(freed));
+        return freed;
+    }
+
+    size_t pending() const noexcept { return retired_.size(); }
+};
+
+#endif //HPORDERBOOK_EPOCH_H
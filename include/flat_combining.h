@@ -0,0 +1,102 @@
+#ifndef HPORDERBOOK_FLAT_COMBINING_H
+#define HPORDERBOOK_FLAT_COMBINING_H
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "locks.h"
+
+// Flat-combining front end. A submitting thread publishes its request in a publication
+// slot; whichever thread wins the combiner flag collects every pending request and hands
+// them to the executor as one batch, then marks them done. Under contention the lock is
+// taken once per batch instead of once per request, and waiting submitters spin on
+// their own slot's cache line rather than on the lock.
+template<typename Request, size_t Slots = 64>
+class FlatCombiner {
+    static_assert(Slots > 0 && Slots <= 1024, "Slots out of range");
+
+private:
+    enum : uint32_t { FREE, CLAIMED, PENDING, DONE };
+
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<uint32_t> state{FREE};
+        Request request;
+    };
+
+    std::array<Slot, Slots> slots_;
+    alignas(CACHE_LINE) std::atomic<bool> combining_{false};
+
+    // Each thread starts its slot search at its own offset
+    static size_t slot_hint() noexcept {
+        static std::atomic<size_t> next_thread{0};
+        thread_local size_t hint = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return hint;
+    }
+
+    Slot& claim_slot() noexcept {
+        SpinWait wait;
+        size_t start = slot_hint();
+        for (;;) {
+            for (size_t i = 0; i < Slots; ++i) {
+                Slot& slot = slots_[(start + i) % Slots];
+                uint32_t expected = FREE;
+                if (slot.state.load(std::memory_order_relaxed) == FREE &&
+                    slot.state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+                    return slot;
+                }
+            }
+            wait();
+        }
+    }
+
+    template<typename Execute>
+    void combine(Execute& execute) {
+        std::array<Request, Slots> batch;
+        std::array<Slot*, Slots> taken;
+        size_t count = 0;
+        for (auto& slot : slots_) {
+            if (slot.state.load(std::memory_order_acquire) == PENDING) {
+                batch[count] = slot.request;
+                taken[count] = &slot;
+                ++count;
+            }
+        }
+        if (count == 0) return;
+        execute(batch.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            taken[i]->request = batch[i];
+            taken[i]->state.store(DONE, std::memory_order_release);
+        }
+    }
+
+public:
+    // Publish `request` and return once it has been executed, by this thread or another.
+    // execute(Request* batch, size_t count) runs on the combining thread only and may
+    // write results into the requests; `request` receives its completed copy.
+    template<typename Execute>
+    void submit(Request& request, Execute&& execute) {
+        Slot& slot = claim_slot();
+        slot.request = request;
+        slot.state.store(PENDING, std::memory_order_release);
+
+        SpinWait wait;
+        while (slot.state.load(std::memory_order_acquire) != DONE) {
+            if (!combining_.load(std::memory_order_relaxed) &&
+                !combining_.exchange(true, std::memory_order_acquire)) {
+                combine(execute);
+                combining_.store(false, std::memory_order_release);
+            } else {
+                wait();
+            }
+        }
+        request = slot.request;
+        slot.state.store(FREE, std::memory_order_release);
+    }
+};
+
+#endif //HPORDERBOOK_FLAT_COMBINING_H
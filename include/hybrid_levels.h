@@ -0,0 +1,241 @@
+#ifndef HPORDERBOOK_HYBRID_LEVELS_H
+#define HPORDERBOOK_HYBRID_LEVELS_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "order_types.h"
+#include "level_bitmap.h"
+
+// Hybrid price level container for one side of the book.
+//
+// Levels near the touch live in a contiguous window of ticks (O(1) find/insert/erase,
+// with a LevelBitmap of occupied slots for O(1) best and next-level lookups);
+// levels outside it, e.g. fat-finger outliers, live in a small sorted vector. Prices are
+// handled as ranks (ticks for asks, negated ticks for bids) so a lower rank is always the
+// better price and the window's front is the touch side. The window recenters on the best
+// level when the touch drifts past its middle or a better price arrives outside it,
+// migrating levels between the window and the outlier set.
+template<typename PriceType, Side S, typename Level = PriceLevel>
+class HybridLevels {
+public:
+    static constexpr size_t DEFAULT_WINDOW_TICKS = 4096;
+    static constexpr bool STABLE_REFERENCES = false;  // recenter() moves levels
+
+private:
+    using Outlier = std::pair<int64_t, Level>;
+
+    PriceType tick_size_;
+    std::vector<Level> window_;     // slot i holds rank window_base_ + i
+    LevelBitmap occupied_;
+    std::vector<Level> scratch_;    // reused by recenter()
+    LevelBitmap scratch_occupied_;
+    int64_t window_base_ = 0;
+    bool anchored_ = false;
+    size_t window_count_ = 0;
+    std::vector<Outlier> outliers_;      // sorted by rank
+
+    int64_t window_end() const noexcept {
+        return window_base_ + static_cast<int64_t>(window_.size());
+    }
+
+    bool in_window(int64_t rank) const noexcept {
+        return anchored_ && rank >= window_base_ && rank < window_end();
+    }
+
+    // Window base that puts `rank` a quarter of the way in, leaving room for better prices
+    int64_t base_for(int64_t rank) const noexcept {
+        return rank - static_cast<int64_t>(window_.size() / 4);
+    }
+
+    typename std::vector<Outlier>::iterator outlier_lower_bound(int64_t rank) {
+        return std::lower_bound(outliers_.begin(), outliers_.end(), rank,
+                                [](const Outlier& o, int64_t r) { return o.first < r; });
+    }
+
+    void recenter(int64_t new_base) {
+        int64_t old_base = window_base_;
+        window_base_ = new_base;
+        anchored_ = true;
+
+        std::fill(scratch_.begin(), scratch_.end(), Level{});
+        scratch_occupied_.reset();
+        std::vector<Outlier> evicted;
+        size_t count = 0;
+
+        for (size_t i = occupied_.first(); i != LevelBitmap::NPOS; i = occupied_.next_set(i + 1)) {
+            int64_t rank = old_base + static_cast<int64_t>(i);
+            if (in_window(rank)) {
+                size_t slot = static_cast<size_t>(rank - window_base_);
+                scratch_[slot] = window_[i];
+                scratch_occupied_.set(slot);
+                ++count;
+            } else {
+                evicted.emplace_back(rank, window_[i]);
+            }
+        }
+
+        // Outliers now inside the window move in; the rest stay sorted
+        auto first = outlier_lower_bound(window_base_);
+        auto last = outlier_lower_bound(window_end());
+        for (auto it = first; it != last; ++it) {
+            size_t slot = static_cast<size_t>(it->first - window_base_);
+            scratch_[slot] = it->second;
+            scratch_occupied_.set(slot);
+            ++count;
+        }
+        outliers_.erase(first, last);
+        if (!evicted.empty()) {
+            size_t middle = outliers_.size();
+            outliers_.insert(outliers_.end(), evicted.begin(), evicted.end());
+            std::inplace_merge(outliers_.begin(), outliers_.begin() + middle, outliers_.end(),
+                               [](const Outlier& a, const Outlier& b) { return a.first < b.first; });
+        }
+
+        window_.swap(scratch_);
+        occupied_.swap(scratch_occupied_);
+        window_count_ = count;
+    }
+
+public:
+    explicit HybridLevels(PriceType tick_size, size_t window_ticks = DEFAULT_WINDOW_TICKS)
+            : tick_size_(tick_size),
+              window_(window_ticks, Level{}), occupied_(window_ticks),
+              scratch_(window_ticks, Level{}), scratch_occupied_(window_ticks) {
+        if (window_ticks < 8 || !(tick_size > PriceType{})) {
+            throw std::invalid_argument("HybridLevels needs a window of at least 8 ticks and a positive tick size");
+        }
+    }
+
+    int64_t rank(PriceType price) const noexcept {
+        int64_t ticks;
+        if constexpr (std::is_floating_point_v<PriceType>) {
+            ticks = std::llround(price / tick_size_);
+        } else {
+            ticks = static_cast<int64_t>(price / tick_size_);
+        }
+        return S == Side::BUY ? -ticks : ticks;
+    }
+
+    // Levels are whole ticks; an off-tick price would be filed under a neighbouring level
+    bool on_tick(PriceType price) const noexcept { return on_tick_grid(price, tick_size_); }
+
+    PriceType price_of(int64_t rank) const noexcept {
+        int64_t ticks = S == Side::BUY ? -rank : rank;
+        return static_cast<PriceType>(ticks) * tick_size_;
+    }
+
+    bool empty() const noexcept { return window_count_ == 0 && outliers_.empty(); }
+    size_t size() const noexcept { return window_count_ + outliers_.size(); }
+    size_t window_levels() const noexcept { return window_count_; }
+    size_t outlier_levels() const noexcept { return outliers_.size(); }
+
+    Level* find(PriceType price) {
+        int64_t r = rank(price);
+        if (in_window(r)) {
+            size_t slot = static_cast<size_t>(r - window_base_);
+            return occupied_.test(slot) ? &window_[slot] : nullptr;
+        }
+        auto it = outlier_lower_bound(r);
+        return (it != outliers_.end() && it->first == r) ? &it->second : nullptr;
+    }
+
+    Level& find_or_insert(PriceType price) {
+        int64_t r = rank(price);
+        // Anchor on the first level, follow a new best that lands outside the window, and
+        // re-anchor an emptied window on the next arrival
+        if (!anchored_ || r < window_base_ || (window_count_ == 0 && !in_window(r))) {
+            recenter(base_for(r));
+        }
+
+        if (in_window(r)) {
+            size_t slot = static_cast<size_t>(r - window_base_);
+            if (!occupied_.test(slot)) {
+                occupied_.set(slot);
+                window_[slot] = Level{};
+                ++window_count_;
+            }
+            return window_[slot];
+        }
+
+        auto it = outlier_lower_bound(r);
+        if (it == outliers_.end() || it->first != r) {
+            it = outliers_.insert(it, Outlier{r, Level{}});
+        }
+        return it->second;
+    }
+
+    void erase(PriceType price) {
+        int64_t r = rank(price);
+        if (in_window(r)) {
+            size_t slot = static_cast<size_t>(r - window_base_);
+            if (occupied_.test(slot)) {
+                occupied_.clear(slot);
+                window_[slot] = Level{};
+                --window_count_;
+            }
+        } else {
+            auto it = outlier_lower_bound(r);
+            if (it != outliers_.end() && it->first == r) outliers_.erase(it);
+        }
+    }
+
+    // Best level, or nullptr if the side is empty. Recenters when the touch has drifted
+    // past the middle of the window or the window has emptied out.
+    Level* best(PriceType& price) {
+        if (empty()) return nullptr;
+        if (window_count_ == 0 || (!outliers_.empty() && outliers_.front().first < window_base_)) {
+            if (window_count_ == 0) {
+                recenter(base_for(outliers_.front().first));
+            } else {
+                price = price_of(outliers_.front().first);
+                return &outliers_.front().second;
+            }
+        }
+        size_t front = occupied_.first();
+        if (front > window_.size() / 2) {
+            recenter(base_for(window_base_ + static_cast<int64_t>(front)));
+            front = occupied_.first();
+        }
+        price = price_of(window_base_ + static_cast<int64_t>(front));
+        return &window_[front];
+    }
+
+    // Best level without recentering, for readers that must not mutate the container
+    const Level* best(PriceType& price) const {
+        if (empty()) return nullptr;
+        if (window_count_ == 0 || (!outliers_.empty() && outliers_.front().first < window_base_)) {
+            price = price_of(outliers_.front().first);
+            return &outliers_.front().second;
+        }
+        size_t front = occupied_.first();
+        price = price_of(window_base_ + static_cast<int64_t>(front));
+        return &window_[front];
+    }
+
+    // Visit levels in priority order; f(price, level) returns false to stop
+    template<typename F>
+    void for_each(F&& f) const {
+        auto it = outliers_.begin();
+        for (; it != outliers_.end() && it->first < window_base_; ++it) {
+            if (!f(price_of(it->first), it->second)) return;
+        }
+        if (anchored_) {
+            for (size_t i = occupied_.first(); i != LevelBitmap::NPOS; i = occupied_.next_set(i + 1)) {
+                if (!f(price_of(window_base_ + static_cast<int64_t>(i)), window_[i])) return;
+            }
+        }
+        for (; it != outliers_.end(); ++it) {
+            if (it->first < window_end()) continue;
+            if (!f(price_of(it->first), it->second)) return;
+        }
+    }
+};
+
+#endif //HPORDERBOOK_HYBRID_LEVELS_H
@@ -0,0 +1,95 @@
+#ifndef HPORDERBOOK_ID_INTERNER_H
+#define HPORDERBOOK_ID_INTERNER_H
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "order_types.h"
+
+// Client id interning at the gateway boundary. Each distinct id gets a dense 32-bit
+// IdHandle (0, 1, 2, ...) that the hot structs carry instead of the 16-byte string, and
+// name() is the reverse table for reporting. Dense handles also index per-order side
+// tables directly, so a cancel by handle needs no hash at all.
+//
+// Lookup is open addressing over handles with linear probing; ids are compared as two
+// 64-bit words. Handles stay valid for the interner's lifetime. Not synchronized.
+class IdInterner {
+private:
+    std::vector<OrderId> names_;    // handle -> id
+    std::vector<uint32_t> slots_;   // handle + 1, or 0 for an empty slot
+    size_t mask_;
+
+    static uint64_t hash(const OrderId& id) noexcept {
+        uint64_t lo, hi;
+        std::memcpy(&lo, id.value.data(), sizeof(lo));
+        std::memcpy(&hi, id.value.data() + sizeof(lo), sizeof(hi));
+        uint64_t h = (lo ^ (hi * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+        return h ^ (h >> 32);
+    }
+
+    static bool same(const OrderId& a, const OrderId& b) noexcept {
+        return std::memcmp(a.value.data(), b.value.data(), OrderId::MAX_LENGTH) == 0;
+    }
+
+    // Slot holding `id`, or the empty slot where it would go
+    size_t probe(const OrderId& id) const noexcept {
+        size_t slot = hash(id) & mask_;
+        while (slots_[slot] != 0 && !same(names_[slots_[slot] - 1], id)) slot = (slot + 1) & mask_;
+        return slot;
+    }
+
+    void grow() {
+        std::vector<uint32_t> old(slots_.size() * 2, 0);
+        slots_.swap(old);
+        mask_ = slots_.size() - 1;
+        for (uint32_t handle = 0; handle < names_.size(); ++handle) {
+            size_t slot = hash(names_[handle]) & mask_;
+            while (slots_[slot] != 0) slot = (slot + 1) & mask_;
+            slots_[slot] = handle + 1;
+        }
+    }
+
+public:
+    explicit IdInterner(size_t expected_ids = 1024) {
+        size_t capacity = 16;
+        while (capacity < expected_ids * 2) capacity <<= 1;
+        slots_.assign(capacity, 0);
+        mask_ = capacity - 1;
+        names_.reserve(expected_ids);
+    }
+
+    size_t size() const noexcept { return names_.size(); }
+
+    IdHandle intern(const OrderId& id) {
+        size_t slot = probe(id);
+        if (slots_[slot] != 0) return slots_[slot] - 1;
+
+        auto handle = static_cast<IdHandle>(names_.size());
+        names_.push_back(id);
+        slots_[slot] = handle + 1;
+        if (names_.size() * 2 > slots_.size()) grow();
+        return handle;
+    }
+
+    IdHandle intern(std::string_view id) {
+        OrderId key;
+        key.set(id);
+        return intern(key);
+    }
+
+    // Handle for an already interned id, or NO_ID
+    IdHandle find(std::string_view id) const noexcept {
+        OrderId key;
+        key.set(id);
+        size_t slot = probe(key);
+        return slots_[slot] != 0 ? slots_[slot] - 1 : NO_ID;
+    }
+
+    const OrderId& name(IdHandle handle) const noexcept { return names_[handle]; }
+};
+
+#endif //HPORDERBOOK_ID_INTERNER_H
@@ -0,0 +1,154 @@
+#ifndef HPORDERBOOK_LEVEL_BITMAP_H
+#define HPORDERBOOK_LEVEL_BITMAP_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical bitmap over price ticks marking non-empty levels.
+// Level 0 holds one bit per tick; each level above holds one bit per non-zero word of
+// the level below, up to a single top word (three levels cover 262,144 ticks). Finding
+// the next or previous occupied tick in either direction takes one tzcnt/lzcnt per level
+// instead of a tick-by-tick scan, so best-level maintenance is O(1) however sparse the
+// book is.
+class LevelBitmap {
+private:
+    size_t size_;
+    std::vector<std::vector<uint64_t>> levels_;  // levels_[0] = tick bits
+
+    static size_t ctz(uint64_t word) noexcept { return static_cast<size_t>(__builtin_ctzll(word)); }
+    static size_t msb(uint64_t word) noexcept { return 63 - static_cast<size_t>(__builtin_clzll(word)); }
+
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    explicit LevelBitmap(size_t size) : size_(size) {
+        size_t bits = size ? size : 1;
+        do {
+            size_t words = (bits + 63) / 64;
+            levels_.emplace_back(words, 0);
+            bits = words;
+        } while (bits > 1);
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool any() const noexcept { return levels_.back()[0] != 0; }
+
+    // Number of set bits: one popcount per tick word
+    size_t count() const noexcept {
+        size_t bits = 0;
+        for (uint64_t word : levels_[0]) bits += static_cast<size_t>(__builtin_popcountll(word));
+        return bits;
+    }
+
+    bool test(size_t i) const noexcept {
+        return (levels_[0][i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(size_t i) noexcept {
+        for (auto& level : levels_) {
+            uint64_t& word = level[i >> 6];
+            bool was_empty = word == 0;
+            word |= uint64_t{1} << (i & 63);
+            if (!was_empty) return;
+            i >>= 6;
+        }
+    }
+
+    void clear(size_t i) noexcept {
+        for (auto& level : levels_) {
+            uint64_t& word = level[i >> 6];
+            word &= ~(uint64_t{1} << (i & 63));
+            if (word != 0) return;
+            i >>= 6;
+        }
+    }
+
+    // Clear ticks first..last inclusive, one word at a time
+    void clear_range(size_t first, size_t last) noexcept {
+        if (first > last) return;
+        for (size_t w = first >> 6; w <= (last >> 6); ++w) {
+            uint64_t mask = ~uint64_t{0};
+            if (w == (first >> 6)) mask &= ~uint64_t{0} << (first & 63);
+            if (w == (last >> 6)) mask &= ~uint64_t{0} >> (63 - (last & 63));
+            uint64_t& word = levels_[0][w];
+            if ((word & mask) == 0) continue;
+            word &= ~mask;
+            if (word == 0 && levels_.size() > 1) {
+                // Propagate the emptied word through the summaries
+                size_t i = w;
+                for (size_t l = 1; l < levels_.size(); ++l) {
+                    uint64_t& summary = levels_[l][i >> 6];
+                    summary &= ~(uint64_t{1} << (i & 63));
+                    if (summary != 0) break;
+                    i >>= 6;
+                }
+            }
+        }
+    }
+
+    // Lowest set tick >= i, or NPOS
+    size_t next_set(size_t i) const noexcept {
+        if (i >= size_) return NPOS;
+        size_t level = 0;
+        size_t pos = i;
+        for (;;) {
+            size_t w = pos >> 6;
+            if (w >= levels_[level].size()) return NPOS;
+            uint64_t bits = levels_[level][w] & (~uint64_t{0} << (pos & 63));
+            if (bits) {
+                pos = (w << 6) | ctz(bits);
+                break;
+            }
+            if (level + 1 == levels_.size()) return NPOS;
+            pos = w + 1;
+            ++level;
+        }
+        while (level > 0) {
+            --level;
+            pos = (pos << 6) | ctz(levels_[level][pos]);
+        }
+        return pos;
+    }
+
+    // Highest set tick <= i, or NPOS
+    size_t prev_set(size_t i) const noexcept {
+        if (size_ == 0 || i == NPOS) return NPOS;
+        if (i >= size_) i = size_ - 1;
+        size_t level = 0;
+        size_t pos = i;
+        for (;;) {
+            size_t w = pos >> 6;
+            uint64_t bits = levels_[level][w] & (~uint64_t{0} >> (63 - (pos & 63)));
+            if (bits) {
+                pos = (w << 6) | msb(bits);
+                break;
+            }
+            if (w == 0 || level + 1 == levels_.size()) return NPOS;
+            pos = w - 1;
+            ++level;
+        }
+        while (level > 0) {
+            --level;
+            pos = (pos << 6) | msb(levels_[level][pos]);
+        }
+        return pos;
+    }
+
+    size_t first() const noexcept { return next_set(0); }
+    size_t last() const noexcept { return size_ ? prev_set(size_ - 1) : NPOS; }
+
+    void reset() noexcept {
+        for (auto& level : levels_) std::fill(level.begin(), level.end(), 0);
+    }
+
+    void swap(LevelBitmap& other) noexcept {
+        std::swap(size_, other.size_);
+        levels_.swap(other.levels_);
+    }
+};
+
+#endif //HPORDERBOOK_LEVEL_BITMAP_H
@@ -0,0 +1,101 @@
+#ifndef HPORDERBOOK_LEVEL_CONTAINERS_H
+#define HPORDERBOOK_LEVEL_CONTAINERS_H
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <type_traits>
+
+#include "order_types.h"
+#include "book_config.h"
+#include "hybrid_levels.h"
+#include "bplus_tree.h"
+#include "price_level_store.h"
+#include "node_pool.h"
+
+// Price levels for one side in a std::pmr::map ordered best-first, exposing the same
+// level-container interface as HybridLevels and BPlusTree. Map nodes never move, so level
+// references stay valid across inserts.
+template<typename PriceType, Side S, typename Level = PriceLevel>
+class MapLevels {
+private:
+    std::pmr::map<PriceType, Level, SidePriority<S>> levels_;
+
+public:
+    static constexpr bool STABLE_REFERENCES = true;
+
+    explicit MapLevels(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : levels_(resource) {}
+
+    size_t size() const noexcept { return levels_.size(); }
+    bool empty() const noexcept { return levels_.empty(); }
+
+    Level* find(PriceType price) {
+        auto it = levels_.find(price);
+        return it != levels_.end() ? &it->second : nullptr;
+    }
+
+    Level& find_or_insert(PriceType price) { return levels_.try_emplace(price).first->second; }
+
+    void erase(PriceType price) { levels_.erase(price); }
+
+    Level* best(PriceType& price) {
+        if (levels_.empty()) return nullptr;
+        price = levels_.begin()->first;
+        return &levels_.begin()->second;
+    }
+
+    const Level* best(PriceType& price) const {
+        if (levels_.empty()) return nullptr;
+        price = levels_.begin()->first;
+        return &levels_.begin()->second;
+    }
+
+    template<typename F>
+    void for_each(F&& f) const {
+        for (const auto& [price, level] : levels_) {
+            if (!f(price, level)) return;
+        }
+    }
+};
+
+// Level container for one side selected by a BookConfig. SOA_LADDER keeps aggregate
+// levels only, so it ignores the level type.
+template<LevelStorage L, typename PriceType, Side S, typename Level>
+using LevelContainer = std::conditional_t<L == LevelStorage::MAP, MapLevels<PriceType, S, Level>,
+                       std::conditional_t<L == LevelStorage::LADDER, HybridLevels<PriceType, S, Level>,
+                       std::conditional_t<L == LevelStorage::BTREE, BTreeLevels<PriceType, S, Level>,
+                                          SoaLevels<PriceType, S>>>>;
+
+// Block of the book's node pool for a level container: map nodes fit the pool's default
+// block, B+tree nodes take whole cache lines. The tick containers allocate no level nodes.
+template<typename Levels>
+struct LevelPoolBlock {
+    static constexpr size_t size = NodePool::DEFAULT_BLOCK_SIZE;
+    static constexpr size_t align = alignof(std::max_align_t);
+};
+
+template<typename K, typename V, typename Compare, size_t NodeKeys>
+struct LevelPoolBlock<BPlusTree<K, V, Compare, NodeKeys>> {
+    static constexpr size_t size = BPlusTree<K, V, Compare, NodeKeys>::NODE_SIZE;
+    static constexpr size_t align = BPlusTree<K, V, Compare, NodeKeys>::NODE_ALIGN;
+};
+
+// Construct any level container from the book's resources; each takes what it uses
+template<typename Levels, typename PriceType>
+Levels make_levels(std::pmr::memory_resource* resource, PriceType tick_size, size_t ladder_ticks,
+                   PriceType base_price) {
+    if constexpr (std::is_constructible_v<Levels, std::pmr::memory_resource*>) {
+        return Levels(resource);
+    } else if constexpr (std::is_constructible_v<Levels, PriceType, PriceType, size_t>) {
+        return Levels(base_price, tick_size, ladder_ticks);
+    } else if constexpr (std::is_constructible_v<Levels, PriceType, size_t>) {
+        return Levels(tick_size, ladder_ticks);
+    } else {
+        return Levels();
+    }
+}
+
+#endif //HPORDERBOOK_LEVEL_CONTAINERS_H
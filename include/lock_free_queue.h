@@ -12,6 +12,7 @@
 template<typename T, size_t N>
 class LockFreeQueue {
     static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
 
 private:
     struct alignas(64) Node {
@@ -19,7 +20,6 @@ private:
         std::atomic<uint64_t> sequence;
     };
 
-    static constexpr uint64_t EMPTY_SEQUENCE = ~0ULL;
     static constexpr size_t BUFFER_MASK = N - 1;
 
     alignas(64) std::atomic<uint64_t> head_{0};
@@ -29,8 +29,9 @@ private:
 public:
     LockFreeQueue() : buffer_(N) {
         try {
-            for (auto& node : buffer_) {
-                node.sequence.store(EMPTY_SEQUENCE, std::memory_order_relaxed);
+            // Slot i is free for the enqueue with ticket i
+            for (size_t i = 0; i < N; ++i) {
+                buffer_[i].sequence.store(i, std::memory_order_relaxed);
             }
         } catch (const std::exception& e) {
             std::cerr << "Failed to initialize queue: " << e.what() << std::endl;
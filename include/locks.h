@@ -0,0 +1,239 @@
+#ifndef HPORDERBOOK_LOCKS_H
+#define HPORDERBOOK_LOCKS_H
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Lock types selectable per book (see BookConfig). Each provides both the exclusive and
+// the shared interface so std::unique_lock / std::shared_lock work with any of them; the
+// spinning locks take shared requests exclusively. Every lock occupies its own cache
+// line so a contended lock word never shares a line with book data.
+
+inline constexpr size_t CACHE_LINE = 64;
+
+// Spin-wait hint: lets the sibling hyperthread run and cuts the pipeline flush on exit
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Spin for a while, then yield: when threads outnumber cores the holder may be descheduled,
+// and burning the rest of the time slice would only delay its release. On a single core
+// spinning can never help, so it yields straight away.
+class SpinWait {
+private:
+    static constexpr uint32_t SPIN_LIMIT = 4096;
+    uint32_t spins_ = 0;
+
+    static uint32_t spin_limit() noexcept {
+        static const uint32_t limit = std::thread::hardware_concurrency() > 1 ? SPIN_LIMIT : 0;
+        return limit;
+    }
+
+public:
+    void operator()() noexcept {
+        if (spins_ < spin_limit()) {
+            ++spins_;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+};
+
+// No synchronization: single-threaded books (backtests, one matcher thread per instrument).
+// Every call is empty and compiles away.
+struct NullLock {
+    void lock() noexcept {}
+    bool try_lock() noexcept { return true; }
+    void unlock() noexcept {}
+    void lock_shared() noexcept {}
+    bool try_lock_shared() noexcept { return true; }
+    void unlock_shared() noexcept {}
+};
+
+// Test-and-test-and-set spinlock with bounded exponential backoff: waiters spin on a plain
+// load so the line stays shared until the holder releases it, and back off after a failed
+// exchange so they do not all retry on the same cycle.
+class alignas(CACHE_LINE) SpinLock {
+private:
+    static constexpr uint32_t MAX_BACKOFF = 1024;  // pause instructions
+
+    std::atomic<bool> locked_{false};
+
+public:
+    void lock() noexcept {
+        uint32_t backoff = 1;
+        SpinWait wait;
+        for (;;) {
+            if (!locked_.exchange(true, std::memory_order_acquire)) return;
+            for (uint32_t i = 0; i < backoff; ++i) cpu_relax();
+            backoff = backoff < MAX_BACKOFF ? backoff * 2 : MAX_BACKOFF;
+            while (locked_.load(std::memory_order_relaxed)) wait();
+        }
+    }
+
+    bool try_lock() noexcept {
+        return !locked_.load(std::memory_order_relaxed) &&
+               !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+    void lock_shared() noexcept { lock(); }
+    bool try_lock_shared() noexcept { return try_lock(); }
+    void unlock_shared() noexcept { unlock(); }
+};
+
+// Ticket lock: FIFO hand-off, so no submitter starves under sustained contention. The
+// flip side is a convoy when threads outnumber cores: the next ticket holder must be
+// scheduled before anyone else can proceed.
+class alignas(CACHE_LINE) TicketLock {
+private:
+    std::atomic<uint32_t> next_{0};
+    std::atomic<uint32_t> serving_{0};
+
+public:
+    void lock() noexcept {
+        uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        SpinWait wait;
+        for (;;) {
+            uint32_t serving = serving_.load(std::memory_order_acquire);
+            if (serving == ticket) return;
+            wait();
+        }
+    }
+
+    bool try_lock() noexcept {
+        uint32_t serving = serving_.load(std::memory_order_acquire);
+        uint32_t expected = serving;
+        return next_.compare_exchange_strong(expected, serving + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    // Only the holder writes serving_
+    void unlock() noexcept {
+        serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void lock_shared() noexcept { lock(); }
+    bool try_lock_shared() noexcept { return try_lock(); }
+    void unlock_shared() noexcept { unlock(); }
+};
+
+// MCS queue lock: each waiter spins on a flag in its own queue node, so a release touches
+// exactly one waiter's cache line instead of invalidating every spinner. Queue nodes come
+// from a small per-thread pool, which keeps the lock()/unlock() interface; a thread that
+// holds more than MAX_HELD MCS locks at once takes the extra nodes from the heap.
+class alignas(CACHE_LINE) McsLock {
+public:
+    static constexpr size_t MAX_HELD = 32;
+
+private:
+    struct alignas(CACHE_LINE) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    struct ThreadNodes {
+        Node nodes[MAX_HELD];
+        uint32_t in_use = 0;   // bit i set while nodes[i] is queued
+    };
+
+    static ThreadNodes& thread_nodes() noexcept {
+        thread_local ThreadNodes pool;
+        return pool;
+    }
+
+    std::atomic<Node*> tail_{nullptr};
+    Node* holder_ = nullptr;   // written and read only by the lock holder
+
+    static_assert(MAX_HELD == 32, "in_use is a 32-bit mask");
+
+    static Node* acquire_node() noexcept {
+        ThreadNodes& pool = thread_nodes();
+        Node* node;
+        if (~pool.in_use != 0) {
+            uint32_t slot = static_cast<uint32_t>(__builtin_ctz(~pool.in_use));
+            pool.in_use |= uint32_t{1} << slot;
+            node = &pool.nodes[slot];
+        } else {
+            node = new Node;
+        }
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->locked.store(true, std::memory_order_relaxed);
+        return node;
+    }
+
+    static void release_node(Node* node) noexcept {
+        ThreadNodes& pool = thread_nodes();
+        if (node >= pool.nodes && node < pool.nodes + MAX_HELD) {
+            pool.in_use &= ~(uint32_t{1} << static_cast<uint32_t>(node - pool.nodes));
+        } else {
+            delete node;
+        }
+    }
+
+public:
+    void lock() noexcept {
+        Node* node = acquire_node();
+        Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+        if (prev) {
+            prev->next.store(node, std::memory_order_release);
+            SpinWait wait;
+            while (node->locked.load(std::memory_order_acquire)) wait();
+        }
+        holder_ = node;
+    }
+
+    bool try_lock() noexcept {
+        Node* node = acquire_node();
+        Node* expected = nullptr;
+        if (!tail_.compare_exchange_strong(expected, node, std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            release_node(node);
+            return false;
+        }
+        holder_ = node;
+        return true;
+    }
+
+    void unlock() noexcept {
+        Node* node = holder_;
+        Node* next = node->next.load(std::memory_order_acquire);
+        if (!next) {
+            Node* expected = node;
+            if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+                release_node(node);
+                return;
+            }
+            // A successor swapped the tail but has not linked itself yet
+            SpinWait wait;
+            while (!(next = node->next.load(std::memory_order_acquire))) wait();
+        }
+        next->locked.store(false, std::memory_order_release);
+        release_node(node);
+    }
+
+    void lock_shared() noexcept { lock(); }
+    bool try_lock_shared() noexcept { return try_lock(); }
+    void unlock_shared() noexcept { unlock(); }
+};
+
+// std::shared_mutex (a pthread rwlock on Linux) on its own cache line
+struct alignas(CACHE_LINE) PaddedSharedMutex : std::shared_mutex {};
+
+#endif //HPORDERBOOK_LOCKS_H
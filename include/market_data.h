@@ -0,0 +1,45 @@
+#ifndef HPORDERBOOK_MARKET_DATA_H
+#define HPORDERBOOK_MARKET_DATA_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "order_types.h"
+
+// Incremental L2 update: the new state of one price level after a book change. A quantity
+// of zero means the level was removed. `sequence` is the exchange sequence number of the
+// message or fill that caused the change, so consumers can order and gap-check updates.
+struct L2Update {
+    double price;
+    uint64_t sequence;
+    uint32_t quantity;
+    uint32_t order_count;
+    Side side;
+    uint8_t reserved[7];
+};
+
+enum class L3Action : uint8_t {
+    ADD,        // order accepted and resting; quantity = resting quantity
+    MODIFY,     // quantity reduced in place, priority kept; quantity = new quantity
+    DELETE,     // order cancelled; quantity = quantity removed
+    EXECUTE     // resting order filled; quantity = quantity executed
+};
+
+// Incremental L3 update: one event on one resting order, keyed by its exchange order id.
+// Applied in sequence order on top of an l3_snapshot() it reproduces the full book.
+struct L3Update {
+    double price;
+    uint64_t sequence;
+    uint64_t order_id;
+    uint32_t quantity;
+    Side side;
+    L3Action action;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(L2Update) == 32, "L2Update must stay half a cache line");
+static_assert(sizeof(L3Update) == 32, "L3Update must stay half a cache line");
+
+#endif //HPORDERBOOK_MARKET_DATA_H
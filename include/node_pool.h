@@ -0,0 +1,111 @@
+#ifndef HPORDERBOOK_NODE_POOL_H
+#define HPORDERBOOK_NODE_POOL_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Fixed-size slab allocator for container nodes (price level map nodes, B+tree nodes).
+// Blocks are carved from large chunks preallocated up front and recycled through an
+// intrusive free list, so steady-state inserts and erases never reach malloc.
+//
+// Not synchronized: a pool belongs to one book and is only touched under that book's
+// write lock (or from a single thread). Requests larger than the block size, or with
+// stricter alignment, are forwarded to the upstream resource.
+class NodePool : public std::pmr::memory_resource {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t block_align_;
+    size_t block_size_;
+    size_t blocks_per_chunk_;
+    std::pmr::memory_resource* upstream_;
+    FreeBlock* free_list_ = nullptr;
+    std::vector<void*> chunks_;
+    size_t blocks_in_use_ = 0;
+
+    void add_chunk() {
+        void* chunk = upstream_->allocate(block_size_ * blocks_per_chunk_, block_align_);
+        chunks_.push_back(chunk);
+        auto* bytes = static_cast<std::byte*>(chunk);
+        // Thread the free list front to back so fresh nodes are handed out in address order
+        for (size_t i = blocks_per_chunk_; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(bytes + i * block_size_);
+            block->next = free_list_;
+            free_list_ = block;
+        }
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes > block_size_ || alignment > block_align_) {
+            return upstream_->allocate(bytes, alignment);
+        }
+        if (!free_list_) {
+            add_chunk();
+        }
+        FreeBlock* block = free_list_;
+        free_list_ = block->next;
+        ++blocks_in_use_;
+        return block;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (bytes > block_size_ || alignment > block_align_) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        auto* block = static_cast<FreeBlock*>(p);
+        block->next = free_list_;
+        free_list_ = block;
+        --blocks_in_use_;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64;
+    static constexpr size_t DEFAULT_CHUNK_BLOCKS = 4096;
+
+    // Preallocates initial_blocks blocks; later growth happens in chunk_blocks steps.
+    // Blocks are aligned to block_align, a power of two.
+    explicit NodePool(size_t initial_blocks = DEFAULT_CHUNK_BLOCKS,
+                      size_t block_size = DEFAULT_BLOCK_SIZE,
+                      size_t chunk_blocks = DEFAULT_CHUNK_BLOCKS,
+                      size_t block_align = alignof(std::max_align_t),
+                      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : block_align_(std::max(block_align, alignof(FreeBlock))),
+              block_size_((std::max(block_size, sizeof(FreeBlock)) + block_align_ - 1) / block_align_ * block_align_),
+              blocks_per_chunk_(chunk_blocks ? chunk_blocks : 1),
+              upstream_(upstream) {
+        size_t preallocated = 0;
+        while (preallocated < initial_blocks) {
+            add_chunk();
+            preallocated += blocks_per_chunk_;
+        }
+    }
+
+    ~NodePool() override {
+        for (void* chunk : chunks_) {
+            upstream_->deallocate(chunk, block_size_ * blocks_per_chunk_, block_align_);
+        }
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    size_t block_size() const noexcept { return block_size_; }
+    size_t blocks_in_use() const noexcept { return blocks_in_use_; }
+    size_t capacity() const noexcept { return chunks_.size() * blocks_per_chunk_; }
+};
+
+#endif //HPORDERBOOK_NODE_POOL_H
@@ -5,171 +5,1512 @@
 
 #include <map>
 #include <shared_mutex>
+#include <mutex>
+#include <algorithm>
 #include <vector>
 #include <optional>
 #include <atomic>
+#include <chrono>
+#include <utility>
+#include <tuple>
+#include <memory>
 
 #include "order_types.h"
 #include "lock_free_queue.h"
+#include "node_pool.h"
+#include "book_config.h"
+#include "level_containers.h"
+#include "order_store.h"
+#include "flat_combining.h"
+#include "id_interner.h"
+#include "sequencer.h"
+#include "broadcast_ring.h"
+#include "market_data.h"
+#include "depth_view.h"
+#include "stop_index.h"
+#include "auction.h"
+#include "allocation.h"
+#include "order_sort.h"
 
-template<typename PriceType>
+// Limit order book. The Config struct (see book_config.h) selects the lock, the level
+// container, aggregate or per-order tracking, fill output, queue capacity and batch width
+// at compile time; OrderBook<double> keeps the original shared_mutex + map behaviour.
+template<typename PriceType, typename Config = DefaultBookConfig>
 class OrderBook {
 public:
-    static constexpr size_t MAX_ORDERS = 1'000'000;
-    static constexpr size_t SIMD_WIDTH = 4; // Processes 4 elements at a time
+    static constexpr size_t MAX_ORDERS = Config::queue_capacity;
+    static constexpr size_t SIMD_WIDTH = Config::batch_width; // Orders per vector update
+    static constexpr size_t LEVEL_POOL_BYTES = size_t{512} << 10; // Level nodes preallocated per book
+    static constexpr size_t ORDER_RECORDS = 8192; // Order records preallocated (per-order books)
+    static constexpr bool PER_ORDER = Config::order_tracking == OrderTracking::PER_ORDER;
+    static constexpr bool SELF_TRADE_PREVENTION = Config::self_trade_prevention != SelfTradePrevention::NONE;
+    static constexpr bool SOA_LEVELS = Config::level_storage == LevelStorage::SOA_LADDER;
+    static constexpr bool POOLED_LEVELS = Config::level_storage == LevelStorage::MAP ||
+                                          Config::level_storage == LevelStorage::BTREE;
+    static constexpr size_t LADDER_WINDOW = 64; // Levels one batch side may span for a single vector update
+
+    using Lock = BookLock<Config::lock_policy>;
+    using Level = std::conditional_t<PER_ORDER, OrderQueueLevel, PriceLevel>;
+    using BidLevels = LevelContainer<Config::level_storage, PriceType, Side::BUY, Level>;
+    using AskLevels = LevelContainer<Config::level_storage, PriceType, Side::SELL, Level>;
+    using L2Feed = BroadcastRing<L2Update, Config::l2_feed_capacity>;
+    using L3Feed = BroadcastRing<L3Update, Config::l3_feed_capacity>;
+    using DepthViews = DepthViewPublisher<Config::depth_view_readers>;
+    using LevelBlock = LevelPoolBlock<BidLevels>;
+    using L3Views = ViewPublisher<L3View, Config::l3_view_readers>;
+
+    static_assert(PER_ORDER || !Config::l3_feed, "The L3 feed needs per-order tracking");
+    static_assert(PER_ORDER || Config::allocation == Allocation::FIFO, "Pro-rata needs per-order tracking");
+    static_assert(PER_ORDER || !SELF_TRADE_PREVENTION, "Self-trade prevention needs per-order tracking");
+    static_assert(!(PER_ORDER && SOA_LEVELS), "The SoA ladder holds aggregate levels only");
+    static_assert(SIMD_WIDTH <= LADDER_WINDOW, "A batch must fit the ladder update window");
 
 private:
+    struct NoOrderStore {
+        explicit NoOrderStore(size_t) {}
+    };
+    struct NoLevelPool {
+        NoLevelPool(size_t, size_t, size_t, size_t) {}
+    };
+    struct NoCombiner {};
+    struct NoL2Feed {};
+    struct NoL3Feed {};
+    struct NoDepthViews {};
+    struct NoL3Views {};
+    struct NoStops {};
+    struct NoAllocation {};
+    struct NoSelfTrade {};
+    struct NoSweepFills {};
+
+    // Outcome of self-trade prevention for the aggressor being matched
+    struct SelfTrade {
+        uint32_t prevented = 0;          // aggressor quantity removed without trading
+        bool cancel_aggressor = false;   // CANCEL_NEWEST fired: stop matching
+    };
+
+    // SoA view of one level's queue for pro-rata allocation, reused across fills
+    struct AllocationScratch {
+        std::vector<uint32_t> index;      // record index, in time priority
+        std::vector<uint32_t> quantity;   // unallocated resting quantity
+        std::vector<uint32_t> share;
+        std::vector<uint32_t> fill;
+        std::vector<uint32_t> requeue;    // icebergs that showed a new slice
+    };
+
+    struct Stops {
+        StopIndex<PriceType, Side::BUY> buys;
+        StopIndex<PriceType, Side::SELL> sells;
+        std::vector<StopOrder> triggered;   // one activation round, reused
+        std::vector<bool> parked_ids;       // by IdHandle: client ids held by parked stops
+        PriceType last_trade{};
+        bool traded = false;
+    };
+
+    // Levels an FOK order consumes, from fillable(); emptied levels are erased only after
+    // the match so the collected pointers stay valid in containers that move levels
+    struct FokPlan {
+        std::vector<std::pair<PriceType, Level*>> levels;
+        std::vector<PriceType> emptied;
+    };
+
+    struct LimitRequest {
+        Order order;
+        IdHandle id;
+        uint64_t order_id;   // result: exchange id, 0 if rejected
+    };
+
     // Lock-free queue for incoming orders
     LockFreeQueue<Order, MAX_ORDERS> incoming_orders_;
 
-    // Price level tracking
-    std::map<PriceType, PriceLevel> bids_;
-    std::map<PriceType, PriceLevel> asks_;
+    // Slab pool for the level map and B+tree nodes (the tick ladders allocate none);
+    // declared first so it outlives both sides
+    [[no_unique_address]] std::conditional_t<POOLED_LEVELS, NodePool, NoLevelPool> level_pool_{
+            LEVEL_POOL_BYTES / LevelBlock::size, LevelBlock::size, LEVEL_POOL_BYTES / LevelBlock::size,
+            LevelBlock::align};
+
+    // Price level tracking, best level first on both sides
+    BidLevels bids_;
+    AskLevels asks_;
+
+    // Resting orders (per-order books only), recycled through the store's free list
+    [[no_unique_address]] std::conditional_t<PER_ORDER, OrderStore, NoOrderStore> orders_{ORDER_RECORDS};
 
     // Thread safety
-    mutable std::shared_mutex mutex_;
+    mutable Lock mutex_;
+
+    // Client id interning; its own lock keeps hashing out of the book's critical section
+    IdInterner ids_;
+    mutable Lock ids_mutex_;
+
+    // Flat-combining front end for add_limit_order
+    [[no_unique_address]] std::conditional_t<Config::flat_combining,
+            FlatCombiner<LimitRequest, Config::combining_slots>, NoCombiner> combiner_;
+
+    // Parked stop orders and the last trade price that fires them
+    [[no_unique_address]] std::conditional_t<Config::stop_orders, Stops, NoStops> stops_;
+
+    [[no_unique_address]] std::conditional_t<Config::allocation != Allocation::FIFO,
+            AllocationScratch, NoAllocation> allocation_;
+
+    [[no_unique_address]] std::conditional_t<SELF_TRADE_PREVENTION, SelfTrade, NoSelfTrade> self_trade_;
+
+    // Fills of one ladder sweep, reused across matches (SoA ladder books)
+    [[no_unique_address]] std::conditional_t<SOA_LEVELS, std::vector<MatchResult>, NoSweepFills> sweep_fills_;
+
+    // Call auction phase: orders rest without matching until uncross()
+    struct AuctionState {
+        bool active = false;
+        AuctionCurves curves;
+        std::vector<PriceType> prices;   // crossed candidate prices, ascending
+        std::vector<uint32_t> bids;      // bid quantity at each candidate
+        std::vector<uint32_t> asks;      // ask quantity at each candidate
+        std::vector<PriceType> side_prices;        // crossed bids while merging
+        std::vector<uint32_t> side_quantities;
+    };
+    AuctionState auction_;
+
+    // Resting quantity per side (indexed by Side), for the FOK pre-check
+    std::array<uint64_t, 2> liquidity_{};
+    [[no_unique_address]] std::conditional_t<SOA_LEVELS, NoSweepFills, FokPlan> fok_plan_;
+
+    // Exchange order ids and sequence numbers; only advanced under the write lock
+    Sequencer<Config::lock_policy != LockPolicy::NONE> next_order_id_;
+
+    // Incremental L2 updates; written under the write lock, read lock-free by subscribers
+    [[no_unique_address]] std::conditional_t<Config::l2_feed, L2Feed, NoL2Feed> l2_feed_;
+    [[no_unique_address]] std::conditional_t<Config::l3_feed, L3Feed, NoL3Feed> l3_feed_;
+
+    // Published depth snapshots for readers that must not take mutex_
+    [[no_unique_address]] std::conditional_t<Config::depth_views, DepthViews, NoDepthViews> depth_views_;
+
+    // Published copies of the resting orders that l3_snapshot() visitors walk without mutex_
+    [[no_unique_address]] std::conditional_t<PER_ORDER, L3Views, NoL3Views> l3_views_;
+
+    template<typename F>
+    decltype(auto) with_levels(Side side, F&& f) {
+        return side == Side::BUY ? f(bids_) : f(asks_);
+    }
+
+    template<typename F>
+    decltype(auto) with_levels(Side side, F&& f) const {
+        return side == Side::BUY ? f(bids_) : f(asks_);
+    }
+
+    // New state of one level after a change; a null level was removed
+    void publish_level(Side side, PriceType price, const Level* level, uint64_t sequence) noexcept {
+        if constexpr (Config::l2_feed) {
+            L2Update update{};
+            update.price = static_cast<double>(price);
+            update.sequence = sequence;
+            update.quantity = level ? level->total_quantity : 0;
+            update.order_count = level ? level->order_count : 0;
+            update.side = side;
+            l2_feed_.publish(update);
+        }
+    }
+
+    // One event on a resting order
+    void publish_order(L3Action action, const RestingOrder& order, uint32_t quantity, uint64_t sequence) noexcept {
+        if constexpr (Config::l3_feed) {
+            L3Update update{};
+            update.price = order.price;
+            update.sequence = sequence;
+            update.order_id = order.order_id;
+            update.quantity = quantity;
+            update.side = order.side;
+            update.action = action;
+            l3_feed_.publish(update);
+        }
+    }
 
-    // Order tracking
-    std::atomic<uint32_t> next_order_id_{0};
+    // One batch of at most SIMD_WIDTH orders. Per-order books reject an id that is
+    // already resting; order_ids[i] receives each order's exchange id, or 0 if rejected.
+    void apply_batch(const Order* orders, const IdHandle* ids, size_t count, uint64_t* order_ids) {
+        alignas(16) std::array<Level*, SIMD_WIDTH> levels{};
+
+        // Create levels (and queue resting orders) first
+        for (size_t i = 0; i < count; ++i) {
+            const Order& order = orders[i];
+            if (!on_ladder(order.side, order.price)) {
+                order_ids[i] = 0;
+                continue;
+            }
+            if constexpr (PER_ORDER) {
+                if (id_in_use(ids ? ids[i] : NO_ID)) {
+                    order_ids[i] = 0;
+                    continue;
+                }
+            }
+            order_ids[i] = next_order_id_.next();
+            liquidity_[static_cast<size_t>(order.side)] += order.quantity;
+            with_levels(order.side, [&](auto& book) {
+                Level& level = book.find_or_insert(order.price);
+                if constexpr (PER_ORDER) {
+                    uint32_t index = orders_.allocate(ids ? ids[i] : NO_ID);
+                    RestingOrder& record = orders_[index];
+                    record.price = order.price;
+                    record.order_id = order_ids[i];
+                    record.quantity = order.quantity;
+                    record.side = order.side;
+                    record.account = order.account;
+                    orders_.append(level, index);
+                    publish_order(L3Action::ADD, record, record.quantity, record.order_id);
+                }
+                levels[i] = &level;
+            });
+        }
+
+        // Containers that move levels on insert are re-resolved once all inserts are done
+        if constexpr (!BidLevels::STABLE_REFERENCES) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!order_ids[i]) continue;
+                levels[i] = with_levels(orders[i].side, [&](auto& book) {
+                    return book.find(orders[i].price);
+                });
+            }
+        }
+
+        // The levels here are scattered nodes, so their totals take plain scalar adds; only
+        // SoA books update contiguous counters with vectors
+        for (size_t i = 0; i < count; ++i) {
+            if (!order_ids[i]) continue;
+            levels[i]->total_quantity += orders[i].quantity;
+            levels[i]->order_count += 1;
+        }
+
+        // A level that several orders join is published once, at the last one's sequence number
+        if constexpr (Config::l2_feed) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!order_ids[i]) continue;
+                bool joined_later = false;
+                for (size_t j = i + 1; j < count; ++j) joined_later |= order_ids[j] && levels[j] == levels[i];
+                if (!joined_later) publish_level(orders[i].side, orders[i].price, levels[i], order_ids[i]);
+            }
+        }
+    }
+
+    // apply_batch for SoA ladder books: no level pointers at all. Each side's orders are
+    // summed into a delta window over the levels they span and added to the store's own
+    // arrays with contiguous vector loads and stores; a side spread wider than LADDER_WINDOW
+    // updates its levels in place one by one. Prices off the ladder are rejected. A level
+    // that several orders join is published once, at the last one's sequence number.
+    void apply_ladder_batch(const Order* orders, size_t count, uint64_t* order_ids) {
+        std::array<size_t, SIMD_WIDTH> level_ids{};
+        for (size_t i = 0; i < count; ++i) {
+            level_ids[i] = with_levels(orders[i].side, [&](auto& book) {
+                return book.store().level_id(orders[i].price);
+            });
+            if (level_ids[i] == PriceLevelStore<PriceType>::NO_LEVEL) {
+                order_ids[i] = 0;
+                continue;
+            }
+            order_ids[i] = next_order_id_.next();
+            liquidity_[static_cast<size_t>(orders[i].side)] += orders[i].quantity;
+        }
+
+        for (Side side : {Side::BUY, Side::SELL}) {
+            with_levels(side, [&](auto& book) {
+                auto& store = book.store();
+                size_t first = SIZE_MAX, last = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (!order_ids[i] || orders[i].side != side) continue;
+                    first = std::min(first, level_ids[i]);
+                    last = std::max(last, level_ids[i]);
+                }
+                if (first == SIZE_MAX) return;
+                if (last - first < LADDER_WINDOW) {
+                    const size_t span = last - first + 1;
+                    alignas(16) std::array<int32_t, LADDER_WINDOW> quantity_deltas;
+                    alignas(16) std::array<int32_t, LADDER_WINDOW> count_deltas;
+                    std::fill_n(quantity_deltas.begin(), span, 0);
+                    std::fill_n(count_deltas.begin(), span, 0);
+                    for (size_t i = 0; i < count; ++i) {
+                        if (!order_ids[i] || orders[i].side != side) continue;
+                        quantity_deltas[level_ids[i] - first] += static_cast<int32_t>(orders[i].quantity);
+                        count_deltas[level_ids[i] - first] += 1;
+                    }
+                    store.apply_window_updates(first, quantity_deltas.data(), count_deltas.data(), span);
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        if (!order_ids[i] || orders[i].side != side) continue;
+                        store.update(level_ids[i], static_cast<int32_t>(orders[i].quantity), 1);
+                    }
+                }
+            });
+        }
+
+        if constexpr (Config::l2_feed) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!order_ids[i]) continue;
+                bool joined_later = false;
+                for (size_t j = i + 1; j < count; ++j) {
+                    joined_later |= order_ids[j] && orders[j].side == orders[i].side && level_ids[j] == level_ids[i];
+                }
+                if (joined_later) continue;
+                with_levels(orders[i].side, [&](auto& book) {
+                    const auto& store = book.store();
+                    PriceLevel level{store.quantity(level_ids[i]), store.count(level_ids[i])};
+                    publish_level(orders[i].side, orders[i].price, &level, order_ids[i]);
+                });
+            }
+        }
+    }
 
     // SIMD-optimized batch processing of limit orders
-    void process_limit_orders_batch(const std::vector<Order>& orders) {
+    void process_limit_orders_batch(const Order* orders, const IdHandle* ids, size_t count,
+                                    uint64_t* order_ids) {
         std::unique_lock lock(mutex_);
+        for (size_t first = 0; first < count; first += SIMD_WIDTH) {
+            if constexpr (SOA_LEVELS) {
+                apply_ladder_batch(orders + first, std::min(SIMD_WIDTH, count - first), order_ids + first);
+            } else {
+                apply_batch(orders + first, ids ? ids + first : nullptr,
+                            std::min(SIMD_WIDTH, count - first), order_ids + first);
+            }
+        }
+    }
 
-        alignas(16) std::array<int32_t, SIMD_WIDTH> deltas{};
-        alignas(16) std::array<PriceLevel*, SIMD_WIDTH> levels{};
+    // Combiner callback: every pending add in one locked batch. The combiner collects adds
+    // in slot order, not arrival order, so the batch is first ranked by (side, price,
+    // timestamp) with OrderSort, before the book lock is taken: orders joining one level
+    // queue, and take their exchange ids, in the order they were made.
+    void execute_limit_requests(LimitRequest* requests, size_t count) {
+        alignas(32) std::array<uint64_t, std::max(Config::combining_slots, OrderSort::NETWORK_SIZE)> keys;
+        std::array<uint32_t, Config::combining_slots> rank;
+        std::array<Order, Config::combining_slots> orders{};   // only [0, count) is read
+        std::array<IdHandle, Config::combining_slots> ids;
+        std::array<uint64_t, Config::combining_slots> order_ids;
+        for (size_t i = 0; i < count; ++i) orders[i] = requests[i].order;
+        OrderSort::rank(orders.data(), count, Config::tick_size, keys.data(), rank.data());
+        for (size_t r = 0; r < count; ++r) {
+            orders[r] = requests[rank[r]].order;
+            ids[r] = requests[rank[r]].id;
+        }
+        process_limit_orders_batch(orders.data(), ids.data(), count, order_ids.data());
+        for (size_t r = 0; r < count; ++r) requests[rank[r]].order_id = order_ids[r];
+    }
 
-        size_t batch_size = 0;
-        for (const auto& order : orders) {
-            auto& book = (order.side == Side::BUY) ? bids_ : asks_;
-            auto [it, inserted] = book.try_emplace(order.price,
-                                                   PriceLevel{order.price, 0, 0, 0}); // Initialize with padding
+    // Show the next slice of the iceberg at the front of `level` and send it to the back
+    // of the queue; it keeps its exchange id. L3 consumers see it re-added at the back.
+    void replenish(OrderQueueLevel& level, uint64_t sequence) noexcept {
+        level.total_quantity += show_next_slice(level.head, sequence);
+        orders_.requeue_front(level);
+    }
 
-            levels[batch_size] = &(it->second);
-            deltas[batch_size] = order.quantity;
+    uint32_t show_next_slice(uint32_t index, uint64_t sequence) noexcept {
+        RestingOrder& order = orders_[index];
+        IcebergReserve& reserve = orders_.reserve(index);
+        uint32_t shown = std::min(reserve.peak, reserve.hidden);
+        reserve.hidden -= shown;
+        order.quantity = shown;
+        liquidity_[static_cast<size_t>(order.side)] += shown;
+        publish_order(L3Action::ADD, order, shown, sequence);
+        return shown;
+    }
 
-            batch_size++;
-            if (batch_size == SIMD_WIDTH) {
-                BatchOperations::process_quantity_updates(levels, deltas, SIMD_WIDTH);
-                batch_size = 0;
+    // Apply the self-trade policy to a resting order of the aggressor's own account, with
+    // `quantity` of the aggressor left. Returns the aggressor quantity removed without a
+    // trade. Cancelled records stay queued until they reach the front. Each event takes a
+    // sequence number; the level itself is published by match_locked.
+    uint32_t prevent_self_trade(Level& level, uint32_t index, uint32_t quantity) {
+        RestingOrder& resting = orders_[index];
+        const uint64_t sequence = next_order_id_.next();
+        auto cancel_resting = [&] {
+            publish_order(L3Action::DELETE, resting, resting.quantity, sequence);
+            level.total_quantity -= resting.quantity;
+            liquidity_[static_cast<size_t>(resting.side)] -= resting.quantity;
+            --level.order_count;
+            orders_.cancel(index);
+        };
+        if constexpr (Config::self_trade_prevention == SelfTradePrevention::CANCEL_OLDEST) {
+            cancel_resting();
+            return 0;
+        } else if constexpr (Config::self_trade_prevention == SelfTradePrevention::CANCEL_NEWEST) {
+            self_trade_.cancel_aggressor = true;
+            return 0;
+        } else {
+            // An iceberg gives up hidden quantity first, so its displayed slice keeps its place
+            uint32_t decrement = quantity;
+            if (resting.flags & RestingOrder::ICEBERG) {
+                IcebergReserve& reserve = orders_.reserve(index);
+                uint32_t hidden = std::min(decrement, reserve.hidden);
+                reserve.hidden -= hidden;
+                decrement -= hidden;
+            }
+            if (decrement >= resting.quantity) {
+                decrement -= resting.quantity;
+                cancel_resting();
+            } else if (decrement > 0) {
+                resting.quantity -= decrement;
+                level.total_quantity -= decrement;
+                liquidity_[static_cast<size_t>(resting.side)] -= decrement;
+                publish_order(L3Action::MODIFY, resting, resting.quantity, sequence);
+                decrement = 0;
             }
+            uint32_t removed = quantity - decrement;
+            self_trade_.prevented += removed;
+            return removed;
         }
+    }
+
+    // Share `quantity`, less than the level's total, across the level's queue. Shares are
+    // floor(quantity * size / total) from the vector kernel, with shares under the minimum
+    // dropped; the rounding remainder then goes in time priority, so the result depends
+    // only on the queue. Fills are reported in time priority and the queue is relinked
+    // without the orders that filled completely.
+    template<typename Sink>
+    uint32_t allocate_level(Level& level, PriceType price, uint32_t quantity, Sink& sink) {
+        AllocationScratch& a = allocation_;
+        a.index.clear();
+        a.quantity.clear();
+        a.requeue.clear();
+        for (uint32_t index = level.head; index != OrderStore::NIL;) {
+            uint32_t next = orders_[index].next;
+            if (orders_[index].flags & RestingOrder::CANCELLED) {
+                orders_.release(index);
+            } else {
+                a.index.push_back(index);
+                a.quantity.push_back(orders_[index].quantity);
+            }
+            index = next;
+        }
+        const size_t count = a.index.size();
+        a.fill.assign(count, 0);
+        a.share.resize(count);
+
+        uint32_t remaining = quantity;
+        uint32_t total = level.total_quantity;
+        if constexpr (Config::allocation == Allocation::FIFO_PRO_RATA) {
+            uint32_t take = std::min(remaining, a.quantity[0]);
+            a.fill[0] = take;
+            a.quantity[0] -= take;
+            remaining -= take;
+            total -= take;
+        }
+        if (remaining > 0) {
+            ProRata::shares(a.quantity.data(), count, remaining, total, a.share.data());
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t share = a.share[i] >= Config::pro_rata_min_allocation ? a.share[i] : 0;
+                a.fill[i] += share;
+                a.quantity[i] -= share;
+                remaining -= share;
+            }
+            for (size_t i = 0; remaining > 0 && i < count; ++i) {
+                uint32_t take = std::min(remaining, a.quantity[i]);
+                a.fill[i] += take;
+                a.quantity[i] -= take;
+                remaining -= take;
+            }
+        }
+
+        level.head = level.tail = OrderStore::NIL;
+        level.total_quantity -= quantity;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t index = a.index[i];
+            RestingOrder& resting = orders_[index];
+            if (a.fill[i] > 0) {
+                MatchResult match;
+                match.price = price;
+                match.sequence = next_order_id_.next();
+                match.order_id = resting.order_id;
+                match.counterparty_id = resting.id;
+                match.quantity = a.fill[i];
+                sink(match);
+                publish_order(L3Action::EXECUTE, resting, a.fill[i], match.sequence);
+                resting.quantity -= a.fill[i];
+                if (resting.quantity == 0) {
+                    if ((resting.flags & RestingOrder::ICEBERG) && orders_.reserve(index).hidden > 0) {
+                        level.total_quantity += show_next_slice(index, match.sequence);
+                        a.requeue.push_back(index);
+                    } else {
+                        orders_.release(index);
+                        --level.order_count;
+                    }
+                    continue;
+                }
+            }
+            orders_.append(level, index);
+        }
+        for (uint32_t index : a.requeue) orders_.append(level, index);
+        return quantity;
+    }
+
+    // Fill against one level's queue, taking from `remaining`; returns the quantity filled.
+    // With self-trade prevention, orders of the aggressor's `account` are met by the policy
+    // instead of trading: the account sits in the record, so the check is one compare.
+    template<typename Sink>
+    uint32_t fill_level_orders(Level& level, PriceType price, uint32_t& remaining, Account account,
+                               Sink& sink) {
+        const bool self_check = SELF_TRADE_PREVENTION && account != NO_ACCOUNT;
+        if constexpr (Config::allocation != Allocation::FIFO) {
+            if constexpr (SELF_TRADE_PREVENTION) {
+                // Own orders anywhere in the level are resolved before it is shared
+                for (uint32_t index = level.head; self_check && index != OrderStore::NIL;
+                     index = orders_[index].next) {
+                    const RestingOrder& resting = orders_[index];
+                    if (!(resting.flags & RestingOrder::CANCELLED) && resting.account == account) {
+                        remaining -= prevent_self_trade(level, index, remaining);
+                        if (remaining == 0 || self_trade_.cancel_aggressor) return 0;
+                    }
+                }
+            }
+            // A level taken whole fills every order in full, so only a partial take is shared
+            if (remaining < level.total_quantity) {
+                uint32_t quantity = remaining;
+                remaining = 0;
+                return allocate_level(level, price, quantity, sink);
+            }
+        }
+        uint32_t filled = 0;
+        while (remaining > 0 && level.head != OrderStore::NIL) {
+            RestingOrder& resting = orders_[level.head];
+            if (resting.next != OrderStore::NIL) __builtin_prefetch(&orders_[resting.next]);
+            if (resting.flags & RestingOrder::CANCELLED) {
+                orders_.pop_front(level);
+                continue;
+            }
+            if constexpr (SELF_TRADE_PREVENTION) {
+                if (self_check && resting.account == account) {
+                    remaining -= prevent_self_trade(level, level.head, remaining);
+                    if (self_trade_.cancel_aggressor) break;
+                    continue;
+                }
+            }
+            uint32_t take = std::min(remaining, resting.quantity);
+
+            MatchResult match;
+            match.price = price;
+            match.sequence = next_order_id_.next();
+            match.order_id = resting.order_id;
+            match.counterparty_id = resting.id;
+            match.quantity = take;
+            sink(match);
+            publish_order(L3Action::EXECUTE, resting, take, match.sequence);
+
+            resting.quantity -= take;
+            remaining -= take;
+            filled += take;
+            if (resting.quantity == 0) {
+                if ((resting.flags & RestingOrder::ICEBERG) && orders_.reserve(level.head).hidden > 0) {
+                    replenish(level, match.sequence);
+                } else {
+                    orders_.pop_front(level);
+                    --level.order_count;
+                }
+            }
+        }
+        level.total_quantity -= filled;
+        return filled;
+    }
+
+    // Price matching against the opposite side, best level first, stopping at the order's
+    // limit price if `limited`. Fills print at each level's price, or at `*print` for an
+    // auction. Aggregate books report the aggressor id on each fill; per-order books
+    // report the resting order's id. Caller holds the write lock.
+    template<typename Sink>
+    uint32_t match_locked(const Order& order, IdHandle id, bool limited, Sink& sink,
+                          const PriceType* print = nullptr) {
+        if constexpr (SOA_LEVELS) {
+            return match_ladder(order, id, limited, sink, print);
+        } else {
+            return match_levels(order, id, limited, sink, print);
+        }
+    }
+
+    template<typename Sink>
+    uint32_t match_levels(const Order& order, IdHandle id, bool limited, Sink& sink, const PriceType* print) {
+        const Side book_side = order.side == Side::BUY ? Side::SELL : Side::BUY;
+        if constexpr (SELF_TRADE_PREVENTION) self_trade_ = SelfTrade{};
+        // An FOK order fills the levels fillable() collected
+        const bool planned = order.type == OrderType::FOK;
+        auto match_side = [&](auto& book) {
+            uint32_t remaining = order.quantity;
+            uint32_t filled = 0;
+            size_t next_planned = 0;
+            PriceType price{};
+            if (planned) fok_plan_.emptied.clear();
+            while (remaining > 0) {
+                Level* level;
+                if (planned) {
+                    if (next_planned == fok_plan_.levels.size()) break;
+                    std::tie(price, level) = fok_plan_.levels[next_planned++];
+                } else {
+                    level = book.best(price);
+                    if (!level) break;
+                    if (limited && (order.side == Side::BUY ? price > order.price : price < order.price)) break;
+                }
+                const PriceType fill_price = print ? *print : price;
+
+                uint32_t matched;
+                if constexpr (PER_ORDER) {
+                    matched = fill_level_orders(*level, fill_price, remaining, order.account, sink);
+                } else {
+                    matched = std::min(remaining, level->total_quantity);
+                    if (matched > 0) {
+                        MatchResult match;
+                        match.quantity = matched;
+                        match.price = fill_price;
+                        match.sequence = next_order_id_.next();
+                        match.counterparty_id = id;
+                        sink(match);
+                        level->total_quantity -= matched;
+                    }
+                    remaining -= matched;
+                }
+                filled += matched;
+                if constexpr (Config::stop_orders) {
+                    if (matched > 0) {
+                        stops_.last_trade = fill_price;
+                        stops_.traded = true;
+                    }
+                }
 
-        if (batch_size > 0) {
-            BatchOperations::process_quantity_updates(levels, deltas, batch_size);
+                if (level->total_quantity == 0) {
+                    if constexpr (PER_ORDER) {
+                        // Cancelled orders left behind the last fill
+                        while (level->head != OrderStore::NIL) orders_.pop_front(*level);
+                    }
+                    publish_level(book_side, price, nullptr, next_order_id_.last());
+                    if (planned) {
+                        fok_plan_.emptied.push_back(price);
+                    } else {
+                        book.erase(price);
+                    }
+                } else {
+                    publish_level(book_side, price, level, next_order_id_.last());
+                }
+                if constexpr (SELF_TRADE_PREVENTION) {
+                    if (self_trade_.cancel_aggressor) {
+                        self_trade_.prevented += remaining;
+                        break;
+                    }
+                }
+            }
+            if (planned) {
+                for (PriceType emptied : fok_plan_.emptied) book.erase(emptied);
+            }
+            return filled;
+        };
+        uint32_t filled = with_levels(book_side, match_side);
+        liquidity_[static_cast<size_t>(book_side)] -= filled;
+        return filled;
+    }
+
+    // match_locked for SoA ladder books: one vectorized sweep of the store's arrays up to
+    // the order's limit (PriceLevelStore::sweep), then a sequence number, sink call and
+    // level update per fill. Every fill but the last empties its level.
+    template<typename Sink>
+    uint32_t match_ladder(const Order& order, IdHandle id, bool limited, Sink& sink, const PriceType* print) {
+        constexpr size_t NO_LEVEL = PriceLevelStore<PriceType>::NO_LEVEL;
+        const Side book_side = order.side == Side::BUY ? Side::SELL : Side::BUY;
+        std::vector<MatchResult>& fills = sweep_fills_;
+        fills.clear();
+        uint32_t filled = with_levels(book_side, [&](auto& book) -> uint32_t {
+            auto& store = book.store();
+            size_t best = store.best_level(book_side);
+            if (best == NO_LEVEL) return 0;
+            size_t bound = book_side == Side::SELL ? store.size() - 1 : 0;
+            if (limited) bound = store.limit_level(book_side, best, order.price);
+            if (bound == NO_LEVEL) return 0;
+            uint32_t remaining = store.sweep(book_side, best, bound, order.quantity, id, fills);
+
+            for (size_t i = 0; i < fills.size(); ++i) {
+                MatchResult& match = fills[i];
+                const PriceType price = static_cast<PriceType>(match.price);
+                match.sequence = next_order_id_.next();
+                if (print) match.price = static_cast<double>(*print);
+                sink(match);
+                if (i + 1 < fills.size()) {
+                    publish_level(book_side, price, nullptr, match.sequence);
+                } else {
+                    size_t level_id = store.level_id(price);
+                    PriceLevel level{store.quantity(level_id), store.count(level_id)};
+                    publish_level(book_side, price, level.total_quantity ? &level : nullptr, match.sequence);
+                }
+            }
+            return order.quantity - remaining;
+        });
+        if constexpr (Config::stop_orders) {
+            if (!fills.empty()) {
+                stops_.last_trade = static_cast<PriceType>(fills.back().price);
+                stops_.traded = true;
+            }
+        }
+        liquidity_[static_cast<size_t>(book_side)] -= filled;
+        return filled;
+    }
+
+    // Aggressor quantity the last match_locked removed by self-trade prevention
+    uint32_t self_trade_prevented() const noexcept {
+        if constexpr (SELF_TRADE_PREVENTION) {
+            return self_trade_.prevented;
+        } else {
+            return 0;
         }
     }
 
-    // SIMD-optimized price matching
-    std::vector<MatchResult> match_market_order_simd(const Order& order) {
+    template<typename Sink>
+    uint32_t match_market_order_simd(const Order& order, IdHandle id, Sink& sink) {
+        if (order.quantity == 0) return 0;  // rejected without a sequence number
         std::unique_lock lock(mutex_);
-        std::vector<MatchResult> matches;
+        if (auction_.active) return 0;
+        next_order_id_.next();  // the market order itself
+        uint32_t filled = match_locked(order, id, false, sink);
+        activate_stops(sink);
+        return filled;
+    }
+
+    // Fire every stop crossed by the last trade, in acceptance order, and repeat while
+    // their own trades cross more. Each round pops only the crossed stops from the
+    // trigger indexes. Caller holds the write lock.
+    template<typename Sink>
+    void activate_stops(Sink& sink) {
+        if constexpr (Config::stop_orders) {
+            auto& triggered = stops_.triggered;
+            while (stops_.traded && !auction_.active) {
+                triggered.clear();
+                stops_.buys.pop_crossed(stops_.last_trade, triggered);
+                stops_.sells.pop_crossed(stops_.last_trade, triggered);
+                if (triggered.empty()) break;
+                std::sort(triggered.begin(), triggered.end(), [](const StopOrder& a, const StopOrder& b) {
+                    return a.order_id < b.order_id;
+                });
+                for (const StopOrder& stop : triggered) {
+                    if constexpr (PER_ORDER) {
+                        if (stop.id != NO_ID) stops_.parked_ids[stop.id] = false;
+                    }
+                    bool limited = stop.type == OrderType::STOP_LIMIT;
+                    Order order = make_order(stop.side, static_cast<PriceType>(stop.limit), stop.quantity,
+                                             limited ? OrderType::LIMIT : OrderType::MARKET);
+                    order.account = stop.account;
+                    uint32_t done = match_locked(order, stop.id, limited, sink) + self_trade_prevented();
+                    // Ids are unique while parked, but check again before the remainder rests
+                    if (limited && done < stop.quantity && !id_in_use(stop.id)) {
+                        order.quantity = stop.quantity - done;
+                        rest_order(order, stop.id, stop.order_id, event_sequence(stop.order_id));
+                    }
+                }
+            }
+        } else {
+            (void)sink;
+        }
+    }
 
-        auto& book = (order.side == Side::BUY) ? asks_ : bids_;
-        uint32_t remaining = order.quantity;
+    // Would an order at `price` on `side` trade against the opposite best? One comparison.
+    bool crosses(Side side, PriceType price) {
+        PriceType best{};
+        if (side == Side::BUY) return asks_.best(best) && best <= price;
+        return bids_.best(best) && best >= price;
+    }
 
-        // Process matches
-        for (auto it = book.begin(); it != book.end() && remaining > 0;) {
-            auto& level = it->second;
-            uint32_t matched = std::min(remaining, level.total_quantity);
+    // Can `quantity` fill at or better than `price`? The side total rejects oversized
+    // orders outright. Otherwise the check is the first half of the match: it reads only
+    // the levels the fill would consume and keeps them in fok_plan_, and match_locked then
+    // fills those levels without looking them up again. Nothing is modified until the
+    // check passes, so a short book needs no rollback. SoA ladder books sum the band up
+    // to `price` with one vector scan instead.
+    bool fillable(Side side, PriceType price, uint32_t quantity, Account account) {
+        const Side book_side = side == Side::BUY ? Side::SELL : Side::BUY;
+        if (liquidity_[static_cast<size_t>(book_side)] < quantity) return false;
+        if constexpr (SOA_LEVELS) {
+            return with_levels(book_side, [&](const auto& book) {
+                const auto& store = book.store();
+                size_t best = store.best_level(book_side);
+                return best != PriceLevelStore<PriceType>::NO_LEVEL &&
+                       store.liquidity_up_to(book_side, best, price) >= quantity;
+            });
+        } else {
+            uint64_t available = 0;
+            bool blocked = false;
+            fok_plan_.levels.clear();
+            with_levels(book_side, [&](auto& book) {
+                book.for_each([&](PriceType level_price, const Level& level) {
+                    if (side == Side::BUY ? level_price > price : level_price < price) return false;
+                    uint64_t level_quantity = level.total_quantity;
+                    if constexpr (SELF_TRADE_PREVENTION) {
+                        if (account != NO_ACCOUNT) {
+                            level_quantity = self_trade_liquidity(level, account, quantity - available);
+                            blocked = level_quantity == NOT_FILLABLE;
+                            if (blocked) return false;
+                        }
+                    }
+                    available += level_quantity;
+                    // The book is ours to mutate; for_each only hands out const views
+                    fok_plan_.levels.push_back({level_price, const_cast<Level*>(&level)});
+                    return available < quantity;
+                });
+            });
+            return !blocked && available >= quantity;
+        }
+    }
 
-            if (matched > 0) {
-                MatchResult match;
-                match.quantity = matched;
-                match.price = level.price;
-                match.set_counterparty_id(order.get_id());
-                matches.push_back(match);
+    static constexpr uint64_t NOT_FILLABLE = UINT64_MAX;
 
-                level.update_quantity(-static_cast<int32_t>(matched));
-                remaining -= matched;
+    // Quantity in `level` an FOK order of `account` that still needs `wanted` can trade.
+    // Own orders never trade. CANCEL_OLDEST just cancels them. Under the other policies,
+    // meeting one before the fill completes removes aggressor quantity, so the order cannot
+    // fill in full and this returns NOT_FILLABLE. Pro-rata levels meet every own order
+    // before sharing.
+    uint64_t self_trade_liquidity(const Level& level, Account account, uint64_t wanted) const {
+        constexpr bool FIFO = Config::allocation == Allocation::FIFO;
+        uint64_t counted = 0;
+        for (uint32_t index = level.head; index != OrderStore::NIL; index = orders_[index].next) {
+            const RestingOrder& resting = orders_[index];
+            if (resting.flags & RestingOrder::CANCELLED) continue;
+            if (resting.account != account) {
+                counted += resting.quantity;
+                if (FIFO && counted >= wanted) break;
+            } else if constexpr (Config::self_trade_prevention != SelfTradePrevention::CANCEL_OLDEST) {
+                if (!FIFO || counted < wanted) return NOT_FILLABLE;
             }
+        }
+        return counted;
+    }
+
+    // Candidate prices where the book is crossed, ascending, with the quantity each side
+    // rests there. Only bids at or above the best ask and asks at or below the best bid
+    // can trade, so only that range is read.
+    void collect_auction_curves() {
+        AuctionState& a = auction_;
+        a.prices.clear();
+        a.bids.clear();
+        a.asks.clear();
+        a.side_prices.clear();
+        a.side_quantities.clear();
+        PriceType best_bid{}, best_ask{};
+        if (!bids_.best(best_bid) || !asks_.best(best_ask) || best_bid < best_ask) return;
 
-            if (level.total_quantity == 0) {
-                it = book.erase(it);
+        // Crossed bids, best (highest) first
+        bids_.for_each([&](PriceType price, const Level& level) {
+            if (price < best_ask) return false;
+            a.side_prices.push_back(price);
+            a.side_quantities.push_back(level.total_quantity);
+            return true;
+        });
+
+        // Merge with the crossed asks, lowest first, walking the bids from the back
+        size_t b = a.side_prices.size();
+        auto emit_bids_below = [&](PriceType limit, bool inclusive) {
+            while (b > 0 && (a.side_prices[b - 1] < limit || (inclusive && a.side_prices[b - 1] == limit))) {
+                --b;
+                a.prices.push_back(a.side_prices[b]);
+                a.bids.push_back(a.side_quantities[b]);
+                a.asks.push_back(0);
+            }
+        };
+        asks_.for_each([&](PriceType price, const Level& level) {
+            if (price > best_bid) return false;
+            emit_bids_below(price, false);
+            if (b > 0 && a.side_prices[b - 1] == price) {
+                --b;
+                a.prices.push_back(price);
+                a.bids.push_back(a.side_quantities[b]);
             } else {
-                ++it;
+                a.prices.push_back(price);
+                a.bids.push_back(0);
             }
+            a.asks.push_back(level.total_quantity);
+            return true;
+        });
+        emit_bids_below(best_bid, true);
+    }
+
+    AuctionResult auction_equilibrium() {
+        collect_auction_curves();
+        return auction_.curves.equilibrium(auction_.prices.data(), auction_.bids.data(),
+                                           auction_.asks.data(), auction_.prices.size());
+    }
+
+    // Rest one already-accepted order at the back of its level, showing at most `display`
+    // of it if that is non-zero (per-order books). The record keeps `order_id`; its feed
+    // events carry `sequence` (see event_sequence). Caller holds the write lock.
+    void rest_order(const Order& order, IdHandle id, uint64_t order_id, uint64_t sequence, uint32_t display = 0) {
+        uint32_t shown = display && display < order.quantity ? display : order.quantity;
+        liquidity_[static_cast<size_t>(order.side)] += shown;
+        if constexpr (SOA_LEVELS) {
+            // Callers have checked on_ladder()
+            with_levels(order.side, [&](auto& book) {
+                auto& store = book.store();
+                size_t level_id = store.level_id(order.price);
+                store.update(level_id, static_cast<int32_t>(shown), 1);
+                PriceLevel level{store.quantity(level_id), store.count(level_id)};
+                publish_level(order.side, order.price, &level, sequence);
+            });
+        } else {
+            rest_in_level(order, id, order_id, sequence, display, shown);
         }
+    }
 
-        return matches;
+    void rest_in_level(const Order& order, IdHandle id, uint64_t order_id, uint64_t sequence, uint32_t display,
+                       uint32_t shown) {
+        with_levels(order.side, [&](auto& book) {
+            Level& level = book.find_or_insert(order.price);
+            if constexpr (PER_ORDER) {
+                uint32_t index = orders_.allocate(id);
+                RestingOrder& record = orders_[index];
+                record.price = order.price;
+                record.order_id = order_id;
+                record.quantity = shown;
+                record.side = order.side;
+                record.account = order.account;
+                if (shown < order.quantity) {
+                    record.flags |= RestingOrder::ICEBERG;
+                    orders_.reserve(index) = IcebergReserve{order.quantity - shown, display};
+                }
+                orders_.append(level, index);
+                publish_order(L3Action::ADD, record, record.quantity, sequence);
+            }
+            level.update_quantity(static_cast<int32_t>(shown));
+            publish_level(order.side, order.price, &level, sequence);
+        });
     }
 
-    // Helper functions to get best prices considering direction
-    PriceType get_best_bid() const {
-        if (bids_.empty()) return 0;
-        // For bids, we want the highest price
-        return std::max_element(bids_.begin(), bids_.end(),
-                                [](const auto& a, const auto& b) { return a.first < b.first; })->first;
+    // Is `id` held by a resting order or a parked stop? Per-order books keep client ids
+    // unique across both; aggregate books do not retain ids.
+    bool id_in_use(IdHandle id) const noexcept {
+        if constexpr (PER_ORDER) {
+            if (id == NO_ID) return false;
+            if (orders_.find(id) != OrderStore::NIL) return true;
+            if constexpr (Config::stop_orders) {
+                return id < stops_.parked_ids.size() && stops_.parked_ids[id];
+            }
+        }
+        return false;
     }
 
-    PriceType get_best_ask() const {
-        if (asks_.empty()) return 0;
-        // For asks, we want the lowest price
-        return std::min_element(asks_.begin(), asks_.end(),
-                                [](const auto& a, const auto& b) { return a.first < b.first; })->first;
+    // Sequence number for the next event of an order accepted as `order_id`: the
+    // acceptance number itself while nothing else has been numbered since, otherwise a
+    // fresh one, so feed sequences never go backwards after the order's own fills
+    uint64_t event_sequence(uint64_t order_id) noexcept {
+        return next_order_id_.last() == order_id ? order_id : next_order_id_.next();
     }
 
-public:
-    OrderBook() = default;
+    // Handle of an id that is already interned, or NO_ID; never adds one
+    IdHandle find_id(std::string_view id) const {
+        std::shared_lock lock(ids_mutex_);
+        return ids_.find(id);
+    }
 
-    // Add a limit order
-    bool add_limit_order(Side side, PriceType price, uint32_t quantity,
-                         std::string_view id) {
-        Order order;
-        order.set_id(id);
+    // Handle for an incoming order's string id. Only an id the book keeps (`retained`: a
+    // parked stop, or an order that may rest on a per-order book) is interned; any other id
+    // is only looked up, so one-off aggressor ids never grow the table.
+    IdHandle order_handle(std::string_view id, bool retained) {
+        return retained ? intern_id(id) : find_id(id);
+    }
+
+    // Can an order at `price` rest? Tick-indexed books file a level by its tick, so they
+    // take prices on the tick only, and SoA ladder books only within their fixed band.
+    bool on_ladder(Side side, PriceType price) const noexcept {
+        if constexpr (SOA_LEVELS) {
+            return with_levels(side, [&](const auto& book) {
+                return book.store().level_id(price) != PriceLevelStore<PriceType>::NO_LEVEL;
+            });
+        } else if constexpr (Config::level_storage == LevelStorage::LADDER) {
+            return with_levels(side, [&](const auto& book) { return book.on_tick(price); });
+        } else {
+            (void)side;
+            (void)price;
+            return true;
+        }
+    }
+
+    // submit_order body: runs under the write lock; `display` sizes a resting iceberg
+    template<typename Sink>
+    OrderResult submit_locked(Order& order, IdHandle id, uint32_t display, Sink& sink) {
+        OrderResult result;
+        const OrderType type = order.type;
+        const uint32_t quantity = order.quantity;
+        // Stops wait for a trigger; they enter through submit_stop_order only
+        if (type == OrderType::STOP || type == OrderType::STOP_LIMIT) return result;
+        if constexpr (PER_ORDER) {
+            bool rests = type == OrderType::LIMIT || type == OrderType::POST_ONLY;
+            if (rests && id_in_use(id)) return result;
+        }
+        if ((type == OrderType::LIMIT || type == OrderType::POST_ONLY) && !on_ladder(order.side, order.price)) {
+            return result;
+        }
+        if (auction_.active) {
+            // Only orders that can rest take part in a call auction
+            if (type != OrderType::LIMIT && type != OrderType::POST_ONLY) return result;
+            result.order_id = next_order_id_.next();
+            rest_order(order, id, result.order_id, result.order_id, display);
+            result.resting = quantity;
+            return result;
+        }
+        if (type == OrderType::POST_ONLY && crosses(order.side, order.price)) return result;
+        if (type == OrderType::FOK && !fillable(order.side, order.price, quantity, order.account)) return result;
+
+        result.order_id = next_order_id_.next();
+        if (type != OrderType::POST_ONLY) {
+            result.filled = match_locked(order, id, type != OrderType::MARKET, sink);
+            result.prevented = self_trade_prevented();
+        }
+        uint32_t remaining = quantity - result.filled - result.prevented;
+        if (remaining > 0 && (type == OrderType::LIMIT || type == OrderType::POST_ONLY)) {
+            order.quantity = remaining;
+            rest_order(order, id, result.order_id, event_sequence(result.order_id), display);
+            result.resting = remaining;
+        }
+        if (result.filled > 0) activate_stops(sink);
+        return result;
+    }
+
+    // Copy the resting orders into a new L3View. The view is sized from the live order
+    // count before the read lock is taken, and taken again if the book has grown past it
+    // meanwhile, so nothing allocates while the lock is held.
+    std::unique_ptr<L3View> copy_l3_view() const requires PER_ORDER {
+        auto view = std::make_unique<L3View>();
+        size_t capacity = resting_orders();
+        for (;;) {
+            view->orders.reserve(capacity);
+            std::shared_lock lock(mutex_);
+            if (orders_.size() > view->orders.capacity()) {
+                capacity = orders_.size() + orders_.size() / 8;
+                continue;
+            }
+            auto copy = [&](const auto& book) {
+                book.for_each([&](PriceType, const Level& level) {
+                    for (uint32_t index = level.head; index != OrderStore::NIL; index = orders_[index].next) {
+                        const RestingOrder& order = orders_[index];
+                        if (!(order.flags & RestingOrder::CANCELLED)) view->orders.push_back(order);
+                    }
+                    return true;
+                });
+            };
+            copy(bids_);
+            copy(asks_);
+            view->sequence = next_order_id_.last();
+            return view;
+        }
+    }
+
+    // Publish a fresh copy; the returned view is only valid while the caller is pinned
+    const L3View* publish_l3_view() requires PER_ORDER {
+        std::unique_ptr<L3View> view = copy_l3_view();
+        const L3View* published = view.get();
+        l3_views_.publish(std::move(view));
+        return published;
+    }
+
+    std::pmr::memory_resource* level_resource() noexcept {
+        if constexpr (POOLED_LEVELS) return &level_pool_;
+        else return nullptr;
+    }
+
+    static Order make_order(Side side, PriceType price, uint32_t quantity, OrderType type) noexcept {
+        Order order{};
         order.price = price;
         order.quantity = quantity;
         order.side = side;
-        order.type = OrderType::LIMIT;
+        order.type = type;
         order.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+        return order;
+    }
 
-        std::vector<Order> batch_orders{order};
-        process_limit_orders_batch(batch_orders);
-        return true;
+public:
+    OrderBook()
+            : bids_(make_levels<BidLevels>(level_resource(), static_cast<PriceType>(Config::tick_size),
+                                           Config::ladder_ticks, static_cast<PriceType>(Config::ladder_base_price))),
+              asks_(make_levels<AskLevels>(level_resource(), static_cast<PriceType>(Config::tick_size),
+                                           Config::ladder_ticks, static_cast<PriceType>(Config::ladder_base_price))) {}
+
+    OrderBook(const OrderBook&) = delete;
+    OrderBook& operator=(const OrderBook&) = delete;
+
+    // Client ids. A gateway interns each id once and passes the handle from then on.
+    // The string_view overloads below intern only ids the book keeps (parked stops, and
+    // orders that may rest on a per-order book) and otherwise look the id up without
+    // adding it. Aggregate-book fills carry the aggressor's handle, so a gateway that wants
+    // those reported interns the aggressor id itself. Known ids resolve under the shared
+    // lock; handles live as long as the book.
+    IdHandle intern_id(std::string_view id) {
+        if (IdHandle known = find_id(id); known != NO_ID) return known;
+        std::unique_lock lock(ids_mutex_);
+        return ids_.intern(id);
+    }
+
+    OrderId id_name(IdHandle id) const {
+        std::shared_lock lock(ids_mutex_);
+        return ids_.name(id);
+    }
+
+    // Number of interned client ids
+    size_t interned_ids() const {
+        std::shared_lock lock(ids_mutex_);
+        return ids_.size();
+    }
+
+    // Add a limit order. Returns its exchange order id, which is also its sequence number
+    // (non-zero, so it tests true), or 0 if rejected: zero quantities are rejected,
+    // per-order books reject an id that is already resting, tick-indexed books (LADDER,
+    // SOA_LADDER) reject prices off the tick and SoA ladder books prices outside the band.
+    uint64_t add_limit_order(Side side, PriceType price, uint32_t quantity, IdHandle id) {
+        if (quantity == 0) return 0;
+        Order order = make_order(side, price, quantity, OrderType::LIMIT);
+        if constexpr (Config::flat_combining) {
+            LimitRequest request{order, id, 0};
+            combiner_.submit(request, [this](LimitRequest* requests, size_t count) {
+                execute_limit_requests(requests, count);
+            });
+            return request.order_id;
+        } else {
+            uint64_t order_id;
+            process_limit_orders_batch(&order, &id, 1, &order_id);
+            return order_id;
+        }
+    }
+
+    // Aggregate books do not retain client ids for resting orders, so they skip interning
+    uint64_t add_limit_order(Side side, PriceType price, uint32_t quantity, std::string_view id) {
+        return add_limit_order(side, price, quantity, PER_ORDER ? intern_id(id) : NO_ID);
+    }
+
+    // Submit an order of any type through the matching path, passing fills to
+    // sink(const MatchResult&). LIMIT trades whatever crosses and rests the remainder;
+    // IOC trades what crosses and drops the rest; FOK trades in full at or better than
+    // `price` or is rejected; POST_ONLY rests only if it would not trade; MARKET ignores
+    // `price`. STOP and STOP_LIMIT are rejected here (see submit_stop_order). LIMIT and
+    // POST_ONLY prices must be able to rest (see add_limit_order). Rejected orders
+    // (order_id 0) consume no sequence number.
+    //
+    // With self_trade_prevention configured, an order with an `account` never trades with
+    // a resting order of the same account; the policy removes quantity instead, reported
+    // as `prevented`. An FOK order only counts liquidity it can trade: the account's own
+    // orders are left out, and under CANCEL_NEWEST or DECREMENT_BOTH an own order met
+    // before the fill completes rejects it, since it would shrink the aggressor.
+    template<typename Sink>
+    OrderResult submit_order(Side side, OrderType type, PriceType price, uint32_t quantity,
+                             IdHandle id, Sink&& sink, Account account = NO_ACCOUNT) {
+        if (quantity == 0) return OrderResult{};
+        Order order = make_order(side, price, quantity, type);
+        order.account = account;
+        std::unique_lock lock(mutex_);
+        return submit_locked(order, id, 0, sink);
+    }
+
+    // Call auction. Between begin_auction() and uncross(), limit and post-only orders rest
+    // without matching and market, IOC and FOK orders are rejected, so the book may cross.
+    void begin_auction() {
+        std::unique_lock lock(mutex_);
+        auction_.active = true;
+    }
+
+    bool in_auction() const {
+        std::shared_lock lock(mutex_);
+        return auction_.active;
+    }
+
+    // Price and volume the auction would uncross at now, without trading
+    AuctionResult indicative_auction() {
+        std::unique_lock lock(mutex_);
+        return auction_equilibrium();
+    }
+
+    // End the auction: compute the equilibrium and execute its volume on both sides at
+    // that one price, in price-time priority, then resume continuous trading. Both sides'
+    // fills go to sink(const MatchResult&): bids first, then asks. Consumes one sequence
+    // number for the uncross itself, then one per fill. Self-trade prevention does not
+    // apply: each side is filled by a synthetic taker for the auction volume (hence
+    // NO_ACCOUNT below), not paired against the other side's orders, so an account's own
+    // bid and ask can both execute at the auction price.
+    template<typename Sink>
+    AuctionResult uncross(Sink&& sink) {
+        std::unique_lock lock(mutex_);
+        AuctionResult result = auction_equilibrium();
+        auction_.active = false;
+        next_order_id_.next();
+        if (result.volume == 0) return result;
+
+        const auto price = static_cast<PriceType>(result.price);
+        for (Side taker : {Side::SELL, Side::BUY}) {
+            // An opposite-side taker of `volume` at the auction price consumes each side
+            uint64_t remaining = result.volume;
+            while (remaining > 0) {
+                uint32_t chunk = static_cast<uint32_t>(std::min<uint64_t>(remaining, UINT32_MAX));
+                Order order = make_order(taker, price, chunk, OrderType::MARKET);
+                uint32_t filled = match_locked(order, NO_ID, false, sink, &price);
+                remaining -= chunk;
+                if (filled < chunk) break;
+            }
+        }
+        activate_stops(sink);
+        return result;
+    }
+
+    // Iceberg limit order (per-order books only): trades what crosses, then rests showing
+    // `display` at a time. Depth and market data carry only the displayed slice. When a
+    // slice fills, the next one is shown at once and joins the back of the level's queue,
+    // without a level lookup or allocation. `resting` in the result includes the reserve.
+    template<typename Sink>
+    OrderResult submit_iceberg_order(Side side, PriceType price, uint32_t quantity, uint32_t display,
+                                     IdHandle id, Sink&& sink, Account account = NO_ACCOUNT) requires PER_ORDER {
+        if (quantity == 0 || display == 0) return OrderResult{};
+        Order order = make_order(side, price, quantity, OrderType::LIMIT);
+        order.account = account;
+        std::unique_lock lock(mutex_);
+        return submit_locked(order, id, display, sink);
+    }
+
+    template<typename Sink>
+    OrderResult submit_iceberg_order(Side side, PriceType price, uint32_t quantity, uint32_t display,
+                                     std::string_view id, Sink&& sink, Account account = NO_ACCOUNT)
+    requires PER_ORDER {
+        return submit_iceberg_order(side, price, quantity, display, intern_id(id), sink, account);
+    }
+
+    // Park a stop order (stop_orders books only). A `limit` of zero makes it a stop-market
+    // order; otherwise it enters as a limit order at `limit` when it fires. The result
+    // reports acceptance only: fills of the stop, including one that fires at once
+    // because the last trade already crossed its trigger, go to `sink` when they happen.
+    // On per-order books a parked stop holds its client id: other orders and stops with
+    // that id are rejected until it fires.
+    template<typename Sink>
+    OrderResult submit_stop_order(Side side, PriceType trigger, PriceType limit, uint32_t quantity,
+                                  IdHandle id, Sink&& sink, Account account = NO_ACCOUNT)
+    requires Config::stop_orders {
+        OrderResult result;
+        if (quantity == 0) return result;
+        std::unique_lock lock(mutex_);
+        if constexpr (PER_ORDER) {
+            if (id_in_use(id)) return result;
+        }
+        if (limit != PriceType{} && !on_ladder(side, limit)) return result;
+
+        StopOrder stop{};
+        stop.trigger = static_cast<double>(trigger);
+        stop.limit = static_cast<double>(limit);
+        stop.order_id = result.order_id = next_order_id_.next();
+        stop.id = id;
+        stop.quantity = quantity;
+        stop.side = side;
+        stop.type = limit != PriceType{} ? OrderType::STOP_LIMIT : OrderType::STOP;
+        stop.account = account;
+        if constexpr (PER_ORDER) {
+            if (id != NO_ID) {
+                if (id >= stops_.parked_ids.size()) stops_.parked_ids.resize(id + 1);
+                stops_.parked_ids[id] = true;
+            }
+        }
+        if (side == Side::BUY) {
+            stops_.buys.add(stop);
+        } else {
+            stops_.sells.add(stop);
+        }
+        activate_stops(sink);
+        return result;
+    }
+
+    template<typename Sink>
+    OrderResult submit_stop_order(Side side, PriceType trigger, PriceType limit, uint32_t quantity,
+                                  std::string_view id, Sink&& sink, Account account = NO_ACCOUNT)
+    requires Config::stop_orders {
+        return submit_stop_order(side, trigger, limit, quantity, order_handle(id, true), sink, account);
+    }
+
+    // Stop orders waiting for their trigger
+    size_t parked_stops() const noexcept requires Config::stop_orders {
+        std::shared_lock lock(mutex_);
+        return stops_.buys.size() + stops_.sells.size();
+    }
+
+    template<typename Sink>
+    OrderResult submit_order(Side side, OrderType type, PriceType price, uint32_t quantity,
+                             std::string_view id, Sink&& sink, Account account = NO_ACCOUNT) {
+        bool rests = type == OrderType::LIMIT || type == OrderType::POST_ONLY;
+        return submit_order(side, type, price, quantity, order_handle(id, PER_ORDER && rests), sink,
+                            account);
+    }
+
+    // Process a market order, passing each fill to sink(const MatchResult&) in match order.
+    // Returns the quantity filled; a zero quantity is rejected without taking a sequence
+    // number. An `account` applies self-trade prevention as in submit_order.
+    // Aggregate-book fills carry the aggressor's id handle; the string_view overloads only
+    // look it up, so it is NO_ID unless the gateway interned the id (see intern_id).
+    template<typename Sink>
+    uint32_t process_market_order(Side side, uint32_t quantity, IdHandle id, Sink&& sink,
+                                  Account account = NO_ACCOUNT) {
+        Order order = make_order(side, PriceType{}, quantity, OrderType::MARKET);
+        order.account = account;
+        return match_market_order_simd(order, id, sink);
+    }
+
+    template<typename Sink>
+    uint32_t process_market_order(Side side, uint32_t quantity, std::string_view id, Sink&& sink,
+                                  Account account = NO_ACCOUNT) {
+        return process_market_order(side, quantity, order_handle(id, false), sink, account);
     }
 
     // Process a market order
-    std::vector<MatchResult> process_market_order(Side side, uint32_t quantity,
-                                                  std::string_view id) {
-        Order order;
-        order.set_id(id);
-        order.price = 0.0;
-        order.quantity = quantity;
-        order.side = side;
-        order.type = OrderType::MARKET;
-        order.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::vector<MatchResult> process_market_order(Side side, uint32_t quantity, IdHandle id)
+    requires (Config::fill_output == FillOutput::VECTOR) {
+        std::vector<MatchResult> matches;
+        process_market_order(side, quantity, id,
+                             [&](const MatchResult& match) { matches.push_back(match); });
+        return matches;
+    }
+
+    std::vector<MatchResult> process_market_order(Side side, uint32_t quantity, std::string_view id)
+    requires (Config::fill_output == FillOutput::VECTOR) {
+        return process_market_order(side, quantity, order_handle(id, false));
+    }
+
+    // Cancel a resting order by id (per-order books only): a direct index from the dense
+    // handle, no hash lookup. Returns false if no order with that id is resting.
+    bool cancel_order(IdHandle id) requires PER_ORDER {
+        std::unique_lock lock(mutex_);
+        uint32_t index = orders_.find(id);
+        if (index == OrderStore::NIL) return false;
+
+        uint64_t sequence = next_order_id_.next();
+        const RestingOrder& record = orders_[index];
+        PriceType price = record.price;
+        Side side = record.side;
+        publish_order(L3Action::DELETE, record, record.quantity, sequence);
+        liquidity_[static_cast<size_t>(side)] -= record.quantity;
+        with_levels(side, [&](auto& book) {
+            Level* level = book.find(price);
+            level->total_quantity -= record.quantity;
+            --level->order_count;
+            orders_.cancel(index);
+            if (level->total_quantity == 0) {
+                while (level->head != OrderStore::NIL) orders_.pop_front(*level);
+                book.erase(price);
+                publish_level(side, price, nullptr, sequence);
+            } else {
+                publish_level(side, price, level, sequence);
+            }
+        });
+        return true;
+    }
+
+    bool cancel_order(std::string_view id) requires PER_ORDER {
+        IdHandle handle = find_id(id);
+        return handle != NO_ID && cancel_order(handle);
+    }
+
+    // Reduce a resting order's quantity in place, keeping its time priority (per-order
+    // books only). Returns false if the order is not resting or `quantity` is not a
+    // reduction; a quantity of zero is a cancel.
+    bool modify_order(IdHandle id, uint32_t quantity) requires PER_ORDER {
+        if (quantity == 0) return cancel_order(id);
+        std::unique_lock lock(mutex_);
+        uint32_t index = orders_.find(id);
+        if (index == OrderStore::NIL || quantity >= orders_[index].quantity) return false;
+
+        uint64_t sequence = next_order_id_.next();
+        RestingOrder& record = orders_[index];
+        with_levels(record.side, [&](auto& book) {
+            Level* level = book.find(static_cast<PriceType>(record.price));
+            level->total_quantity -= record.quantity - quantity;
+            liquidity_[static_cast<size_t>(record.side)] -= record.quantity - quantity;
+            record.quantity = quantity;
+            publish_order(L3Action::MODIFY, record, quantity, sequence);
+            publish_level(record.side, static_cast<PriceType>(record.price), level, sequence);
+        });
+        return true;
+    }
 
-        return match_market_order_simd(order);
+    // Every resting order, bids then asks, best level first and in time priority within a
+    // level: f(const RestingOrder&). f walks an immutable L3View published through
+    // epoch-based RCU, with no lock held, so a slow visitor never holds up the matcher and
+    // may act on the book itself. Repeated snapshots of an unchanged book share one view;
+    // after a change the first snapshot copies the 32-byte records into a new view under
+    // the read lock. Returns the sequence number the snapshot reflects; a late joiner
+    // takes an l3_feed() reader first, then the snapshot, then applies the updates with a
+    // higher sequence. Each snapshot claims one of the l3_view_readers slots while it runs;
+    // when all are taken (more concurrent snapshots, or a visitor nesting them) it walks a
+    // private copy instead of waiting for one.
+    template<typename F>
+    uint64_t l3_snapshot(F&& f) requires PER_ORDER {
+        auto reader = l3_views_.try_reader();
+        if (!reader) {
+            std::unique_ptr<L3View> copy = copy_l3_view();
+            for (const RestingOrder& order : copy->orders) f(order);
+            return copy->sequence;
+        }
+        auto guard = reader->pin();
+        const L3View* view = l3_views_.current();
+        // Every change to the resting orders takes a sequence number
+        if (!view || view->sequence != next_order_id_.last()) view = publish_l3_view();
+        for (const RestingOrder& order : view->orders) f(order);
+        return view->sequence;
     }
 
+    // L2 update stream (l2_feed books only). Subscribers take a reader() and poll it at
+    // their own pace; a slow reader is told how many updates it lost and should re-sync
+    // from get_depth().
+    const L2Feed& l2_feed() const noexcept requires Config::l2_feed { return l2_feed_; }
+
+    // Order-by-order event stream (l3_feed books only), read the same way as l2_feed()
+    const L3Feed& l3_feed() const noexcept requires Config::l3_feed { return l3_feed_; }
+
+    // Sequence number of the last accepted message or fill
+    uint64_t last_sequence() const noexcept { return next_order_id_.last(); }
+
     // Get current best bid/ask prices
     std::pair<PriceType, PriceType> get_best_prices() const {
         std::shared_lock lock(mutex_);
-        return {get_best_bid(), get_best_ask()};
+        PriceType bid{}, ask{};
+        if (!bids_.best(bid)) bid = 0;
+        if (!asks_.best(ask)) ask = 0;
+        return {bid, ask};
     }
 
     // Get current depth at price level
-    std::vector<PriceLevel> get_depth(Side side, size_t levels = 5) const {
+    std::vector<DepthLevel> get_depth(Side side, size_t levels = 5) const {
         std::shared_lock lock(mutex_);
-        std::vector<PriceLevel> depth;
-        const auto& book = (side == Side::BUY) ? bids_ : asks_;
+        std::vector<DepthLevel> depth;
+        with_levels(side, [&](const auto& book) {
+            book.for_each([&](PriceType price, const Level& level) {
+                if (depth.size() == levels) return false;
+                depth.push_back(DepthLevel{static_cast<double>(price), level.total_quantity, level.order_count});
+                return true;
+            });
+        });
+        return depth;
+    }
 
-        std::vector<std::pair<PriceType, PriceLevel>> sorted_levels(book.begin(), book.end());
-        if (side == Side::BUY) {
-            // Sort bids in descending order
-            std::sort(sorted_levels.begin(), sorted_levels.end(),
-                      [](const auto& a, const auto& b) { return a.first > b.first; });
-        } else {
-            // Sort asks in ascending order
-            std::sort(sorted_levels.begin(), sorted_levels.end(),
-                      [](const auto& a, const auto& b) { return a.first < b.first; });
+    // Copy up to `levels` levels per side into a new immutable view and publish it
+    // (depth_views books only). Holds the read lock for the copy only. Call it from a
+    // timer or whenever readers need fresher data; returns the view's sequence number.
+    uint64_t publish_depth_view(size_t levels = SIZE_MAX) requires Config::depth_views {
+        auto view = std::make_unique<DepthView>();
+        {
+            std::shared_lock lock(mutex_);
+            auto copy = [&](const auto& book, std::vector<DepthLevel>& out) {
+                out.reserve(std::min(levels, book.size()));
+                book.for_each([&](PriceType price, const Level& level) {
+                    if (out.size() == levels) return false;
+                    out.push_back(DepthLevel{static_cast<double>(price), level.total_quantity, level.order_count});
+                    return true;
+                });
+            };
+            copy(bids_, view->bids);
+            copy(asks_, view->asks);
+            view->sequence = next_order_id_.last();
         }
+        uint64_t sequence = view->sequence;
+        depth_views_.publish(std::move(view));
+        return sequence;
+    }
 
-        for (size_t i = 0; i < levels && i < sorted_levels.size(); ++i) {
-            depth.push_back(sorted_levels[i].second);
-        }
+    // Register a depth view reader; each reader thread keeps one. A reader pins, reads
+    // depth_view() and walks it with no lock while the guard lives:
+    //     auto guard = reader.pin();
+    //     if (const DepthView* view = book.depth_view()) { ... }
+    typename DepthViews::Domain::Reader depth_reader() requires Config::depth_views {
+        return depth_views_.reader();
+    }
 
-        return depth;
+    // Latest published view, or nullptr; only valid under a pin
+    const DepthView* depth_view() const noexcept requires Config::depth_views {
+        return depth_views_.current();
+    }
+
+    // Number of resting orders (per-order books only)
+    size_t resting_orders() const noexcept requires PER_ORDER {
+        std::shared_lock lock(mutex_);
+        return orders_.size();
     }
 };
 
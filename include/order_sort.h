@@ -0,0 +1,246 @@
+#ifndef HPORDERBOOK_ORDER_SORT_H
+#define HPORDERBOOK_ORDER_SORT_H
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "order_types.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+// Batch priority ordering for orders (flat-combining batch insertion, auction order books).
+// Each order is reduced to a 64-bit integer sort key so ranking is a plain unsigned compare:
+//
+//   bit  63      side (BUY sorts before SELL)
+//   bits 62..32  price in ticks; inverted for BUY so the best price of either side sorts first
+//   bits 31..0   arrival time in ns relative to the earliest order in the batch
+//
+// Batches whose prices or time span do not fit fall back to an exact comparison sort.
+// Batches of up to NETWORK_SIZE orders go through a vectorized sorting network, with the
+// order's batch index folded into the low bits of the time offset so equal keys cannot occur.
+struct OrderSort {
+    static constexpr size_t NETWORK_SIZE = 16;
+    static constexpr unsigned NETWORK_INDEX_BITS = 4;
+    static constexpr int64_t MAX_PRICE_TICKS = (int64_t{1} << 31) - 1;
+
+    // Key for one order; returns false if it cannot be represented exactly
+    static bool make_key(const Order& order, double tick_size, uint64_t base_timestamp,
+                         uint64_t& key) noexcept {
+        double ticks_exact = order.price / tick_size;
+        int64_t ticks = std::llround(ticks_exact);
+        uint64_t offset = order.timestamp - base_timestamp;
+        if (ticks < 0 || ticks > MAX_PRICE_TICKS || std::fabs(ticks_exact - ticks) > 1e-6 ||
+            order.timestamp < base_timestamp || offset > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        uint64_t price_rank = order.side == Side::BUY
+                              ? static_cast<uint64_t>(MAX_PRICE_TICKS - ticks)
+                              : static_cast<uint64_t>(ticks);
+        key = (static_cast<uint64_t>(order.side == Side::SELL) << 63) | (price_rank << 32) | offset;
+        return true;
+    }
+
+    // Priority order of orders[0 .. n): bids best-first, then asks best-first, FIFO within
+    // a price. index[r] receives the batch position of the r-th order. `keys` is scratch
+    // for max(n, NETWORK_SIZE) keys; nothing is allocated. Batches of up to NETWORK_SIZE
+    // go through the sorting network with the batch index folded into the time offset;
+    // larger ones sort the folded keys, or key and index pairs if the offsets leave no
+    // room for the index.
+    static void rank(const Order* orders, size_t n, double tick_size, uint64_t* keys, uint32_t* index) {
+        for (size_t i = 0; i < n; ++i) index[i] = static_cast<uint32_t>(i);
+        if (n < 2) return;
+
+        uint64_t base_timestamp = orders[0].timestamp;
+        for (size_t i = 1; i < n; ++i) base_timestamp = std::min(base_timestamp, orders[i].timestamp);
+
+        uint64_t max_offset = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!make_key(orders[i], tick_size, base_timestamp, keys[i])) {
+                rank_exact(orders, n, index);
+                return;
+            }
+            max_offset = std::max(max_offset, keys[i] & 0xFFFFFFFFu);
+        }
+
+        const unsigned index_bits = std::max(NETWORK_INDEX_BITS, static_cast<unsigned>(std::bit_width(n - 1)));
+        if (max_offset >> (32 - index_bits) != 0) {
+            std::sort(index, index + n, [keys](uint32_t a, uint32_t b) {
+                return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            });
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t offset = keys[i] & 0xFFFFFFFFu;
+            keys[i] = (keys[i] - offset) | offset << index_bits | i;
+        }
+        if (n <= NETWORK_SIZE) {
+            std::fill(keys + n, keys + NETWORK_SIZE, std::numeric_limits<uint64_t>::max());
+            sort_network<NETWORK_SIZE>(keys);
+        } else {
+            std::sort(keys, keys + n);   // distinct keys, so no stability needed
+        }
+        const uint64_t index_mask = (uint64_t{1} << index_bits) - 1;
+        for (size_t i = 0; i < n; ++i) index[i] = static_cast<uint32_t>(keys[i] & index_mask);
+    }
+
+    // Reorder orders into priority order (see rank)
+    static void sort_by_priority(std::vector<Order>& orders, double tick_size) {
+        size_t n = orders.size();
+        if (n < 2) return;
+        std::vector<uint64_t> keys(std::max(n, NETWORK_SIZE));
+        std::vector<uint32_t> index(n);
+        rank(orders.data(), n, tick_size, keys.data(), index.data());
+
+        std::vector<Order> sorted(n);
+        for (size_t i = 0; i < n; ++i) sorted[i] = orders[index[i]];
+        orders.swap(sorted);
+    }
+
+    // Bitonic sorting network over exactly N distinct keys (N a power of two up to
+    // NETWORK_SIZE; pad with UINT64_MAX). Each stage compare-exchanges keys i and i ^ J,
+    // ascending where (i & K) == 0. AVX2 exchanges four pairs per instruction once J >= 4,
+    // SSE4.2 and NEON two; x86 only compares signed 64-bit lanes, so both operands are
+    // XORed with the sign bit first. Callers make keys distinct by folding in an index.
+    // J and K are template parameters so only the stage shapes N can reach are instantiated.
+    template<size_t N>
+    static void sort_network(uint64_t* keys) noexcept {
+        static_assert(N >= 2 && N <= NETWORK_SIZE && (N & (N - 1)) == 0, "Network size must be a power of two");
+        if constexpr (N == 2) {
+            // One compare-exchange, narrower than a vector of pairs
+            uint64_t low = std::min(keys[0], keys[1]);
+            keys[1] = std::max(keys[0], keys[1]);
+            keys[0] = low;
+        } else {
+            network_merge<N, 2>(keys);
+        }
+    }
+
+private:
+    // Bitonic merges of width K, K * 2, ... N
+    template<size_t N, size_t K>
+    static void network_merge(uint64_t* keys) noexcept {
+        network_stages<N, K / 2, K>(keys);
+        if constexpr (K < N) network_merge<N, K * 2>(keys);
+    }
+
+    // Stages J, J / 2, ... 1 of one merge
+    template<size_t N, size_t J, size_t K>
+    static void network_stages(uint64_t* keys) noexcept {
+        network_stage<N, J, K>(keys);
+        if constexpr (J > 1) network_stages<N, J / 2, K>(keys);
+    }
+
+    template<size_t N, size_t J, size_t K>
+    static void network_stage(uint64_t* keys) noexcept {
+        static_assert(N >= 4 && J < K && K <= N, "Stage outside the network");
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        // Two pairs per step; lane l of `descending` is set where its pair sorts high-first
+        auto exchange = [](uint64x2_t& a, uint64x2_t& b, uint64x2_t descending) {
+            uint64x2_t swap = veorq_u64(vcgtq_u64(a, b), descending);
+            uint64x2_t low = vbslq_u64(swap, b, a);
+            b = vbslq_u64(swap, a, b);
+            a = low;
+        };
+        auto direction = [](size_t i) { return (i & K) ? ~uint64_t{0} : uint64_t{0}; };
+        if constexpr (J == 1) {
+            for (size_t i = 0; i < N; i += 4) {
+                uint64x2_t v0 = vld1q_u64(keys + i), v1 = vld1q_u64(keys + i + 2);
+                uint64x2_t a = vzip1q_u64(v0, v1), b = vzip2q_u64(v0, v1);
+                uint64_t lanes[2] = {direction(i), direction(i + 2)};
+                exchange(a, b, vld1q_u64(lanes));
+                vst1q_u64(keys + i, vzip1q_u64(a, b));
+                vst1q_u64(keys + i + 2, vzip2q_u64(a, b));
+            }
+        } else {
+            for (size_t i = 0; i < N; i += 2) {
+                if (i & J) continue;
+                uint64x2_t a = vld1q_u64(keys + i), b = vld1q_u64(keys + i + J);
+                exchange(a, b, vdupq_n_u64(direction(i)));
+                vst1q_u64(keys + i, a);
+                vst1q_u64(keys + i + J, b);
+            }
+        }
+#elif defined(__SSE4_2__)
+        const __m128i bias = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+        auto exchange = [&bias](__m128i& a, __m128i& b, __m128i descending) {
+            __m128i greater = _mm_cmpgt_epi64(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+            __m128i swap = _mm_xor_si128(greater, descending);
+            __m128i low = _mm_blendv_epi8(a, b, swap);
+            b = _mm_blendv_epi8(b, a, swap);
+            a = low;
+        };
+        auto direction = [](size_t i) { return (i & K) ? int64_t{-1} : int64_t{0}; };
+#if defined(__AVX2__)
+        constexpr bool WIDE = J >= 4;
+#else
+        constexpr bool WIDE = false;
+#endif
+        if constexpr (WIDE) {
+#if defined(__AVX2__)
+            const __m256i bias4 = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+            for (size_t i = 0; i < N; i += 4) {
+                if (i & J) continue;
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i + J));
+                __m256i greater = _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias4), _mm256_xor_si256(b, bias4));
+                __m256i swap = _mm256_xor_si256(greater, _mm256_set1_epi64x(direction(i)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_blendv_epi8(a, b, swap));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i + J), _mm256_blendv_epi8(b, a, swap));
+            }
+#endif
+        } else if constexpr (J == 1) {
+            for (size_t i = 0; i < N; i += 4) {
+                __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i + 2));
+                __m128i a = _mm_unpacklo_epi64(v0, v1), b = _mm_unpackhi_epi64(v0, v1);
+                exchange(a, b, _mm_set_epi64x(direction(i + 2), direction(i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), _mm_unpacklo_epi64(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i + 2), _mm_unpackhi_epi64(a, b));
+            }
+        } else {
+            for (size_t i = 0; i < N; i += 2) {
+                if (i & J) continue;
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i + J));
+                exchange(a, b, _mm_set1_epi64x(direction(i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), a);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i + J), b);
+            }
+        }
+#else
+        // Branchless selects; the loop bounds are constants, so this unrolls
+        for (size_t i = 0; i < N; ++i) {
+            size_t l = i ^ J;
+            if (l <= i) continue;
+            bool swap = (keys[i] > keys[l]) == ((i & K) == 0);
+            uint64_t ki = keys[i], kl = keys[l];
+            keys[i] = swap ? kl : ki;
+            keys[l] = swap ? ki : kl;
+        }
+#endif
+    }
+
+    // Exact comparison on the order fields, batch position breaking ties
+    static void rank_exact(const Order* orders, size_t n, uint32_t* index) {
+        std::sort(index, index + n, [orders](uint32_t a, uint32_t b) {
+            const Order& x = orders[a];
+            const Order& y = orders[b];
+            if (x.side != y.side) return x.side == Side::BUY;
+            if (y < x) return true;
+            if (x < y) return false;
+            return a < b;
+        });
+    }
+};
+
+#endif //HPORDERBOOK_ORDER_SORT_H
@@ -0,0 +1,151 @@
+#ifndef HPORDERBOOK_ORDER_STORE_H
+#define HPORDERBOOK_ORDER_STORE_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "order_types.h"
+
+// Resting order record for per-order books. Records live in one contiguous OrderStore and
+// are linked into their level's FIFO by 32-bit index, so a level queue costs two words
+// in the level and no allocation per order. A cancelled order is zeroed in place and
+// unlinked lazily when it reaches the front of its queue.
+struct RestingOrder {
+    static constexpr uint8_t CANCELLED = 1;
+    static constexpr uint8_t ICEBERG = 2;   // hidden reserve in the OrderStore side table
+
+    double price;
+    uint64_t order_id;   // exchange id: the acceptance sequence number, so FIFO order too
+    IdHandle id;
+    uint32_t quantity;   // displayed quantity; 0 once cancelled
+    uint32_t next;       // next order at the same level, or OrderStore::NIL; free-list link
+    Side side;
+    uint8_t flags;
+    Account account;     // compared inline by self-trade prevention
+};
+
+// Level value for per-order books: the aggregate plus the head and tail of its order FIFO.
+// Derives from PriceLevel so the batch update kernels work on either level type.
+struct OrderQueueLevel : PriceLevel {
+    uint32_t head = UINT32_MAX;
+    uint32_t tail = UINT32_MAX;
+};
+
+static_assert(sizeof(RestingOrder) == 32, "RestingOrder must stay half a cache line");
+static_assert(sizeof(OrderQueueLevel) == 16, "OrderQueueLevel must pack four to a cache line");
+
+// Hidden part of an iceberg order, kept beside the records so RestingOrder stays 32 bytes
+struct IcebergReserve {
+    uint32_t hidden;   // quantity not yet displayed
+    uint32_t peak;     // displayed quantity after each replenish
+};
+
+class OrderStore {
+private:
+    std::vector<RestingOrder> records_;
+    std::vector<IcebergReserve> reserves_;   // parallel to records_; read for ICEBERG records only
+    std::vector<uint32_t> by_id_;   // IdHandle -> record index; handles are dense
+    uint32_t free_head_;
+    size_t live_ = 0;
+
+public:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    explicit OrderStore(size_t reserve = 0) : free_head_(NIL) {
+        records_.reserve(reserve);
+        reserves_.reserve(reserve);
+    }
+
+    size_t size() const noexcept { return live_; }
+
+    RestingOrder& operator[](uint32_t index) noexcept { return records_[index]; }
+    const RestingOrder& operator[](uint32_t index) const noexcept { return records_[index]; }
+
+    // Record index of the resting order with this id, or NIL
+    uint32_t find(IdHandle id) const noexcept {
+        return id < by_id_.size() ? by_id_[id] : NIL;
+    }
+
+    void unbind(uint32_t index) noexcept {
+        IdHandle id = records_[index].id;
+        if (id != NO_ID && by_id_[id] == index) by_id_[id] = NIL;
+    }
+
+    // New record, bound to its id (NO_ID orders cannot be looked up)
+    uint32_t allocate(IdHandle id) {
+        ++live_;
+        uint32_t index;
+        if (free_head_ != NIL) {
+            index = free_head_;
+            free_head_ = records_[index].next;
+        } else {
+            records_.emplace_back();
+            reserves_.emplace_back();
+            index = static_cast<uint32_t>(records_.size() - 1);
+        }
+        records_[index].id = id;
+        records_[index].flags = 0;
+        records_[index].account = NO_ACCOUNT;
+        if (id != NO_ID) {
+            if (id >= by_id_.size()) by_id_.resize(std::max<size_t>(id + 1, by_id_.size() * 2), NIL);
+            by_id_[id] = index;
+        }
+        return index;
+    }
+
+    IcebergReserve& reserve(uint32_t index) noexcept { return reserves_[index]; }
+
+    // Cancel in place: the record leaves the id table and the live count now, and its
+    // queue slot when it reaches the front
+    void cancel(uint32_t index) noexcept {
+        RestingOrder& record = records_[index];
+        unbind(index);
+        record.quantity = 0;
+        record.flags |= RestingOrder::CANCELLED;
+        --live_;
+    }
+
+    void release(uint32_t index) noexcept {
+        RestingOrder& record = records_[index];
+        if (!(record.flags & RestingOrder::CANCELLED)) {
+            unbind(index);
+            --live_;
+        }
+        record.next = free_head_;
+        free_head_ = index;
+    }
+
+    // Append a record to the back of a level's queue
+    void append(OrderQueueLevel& level, uint32_t index) noexcept {
+        records_[index].next = NIL;
+        if (level.tail == NIL) {
+            level.head = index;
+        } else {
+            records_[level.tail].next = index;
+        }
+        level.tail = index;
+    }
+
+    // Move the order at the front of a level's queue to the back: an iceberg that has
+    // replenished loses its time priority. No allocation and no level lookup.
+    void requeue_front(OrderQueueLevel& level) noexcept {
+        uint32_t index = level.head;
+        if (index == level.tail) return;
+        level.head = records_[index].next;
+        append(level, index);
+    }
+
+    // Unlink and free the order at the front of a level's queue
+    void pop_front(OrderQueueLevel& level) noexcept {
+        uint32_t index = level.head;
+        level.head = records_[index].next;
+        if (level.head == NIL) level.tail = NIL;
+        release(index);
+    }
+};
+
+#endif //HPORDERBOOK_ORDER_STORE_H
@@ -7,49 +7,103 @@
 #include <array>
 #include <string_view>
 #include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+#include <cmath>
+
+#if defined(__ARM_NEON)
 #include <arm_neon.h> // for Mac M1
+#elif defined(__SSE2__)
+#include <emmintrin.h> // x86 fallback for the NEON kernels
+#endif
 
 enum class Side : uint8_t {
     BUY,
     SELL
 };
 
+// Price priority for one side of the book, usable as an ordered-container comparator:
+// bids rank higher prices first, asks lower prices first, so the best level is begin()
+template<Side S>
+struct SidePriority {
+    template<typename P>
+    constexpr bool operator()(const P& a, const P& b) const noexcept {
+        if constexpr (S == Side::BUY) {
+            return a > b;
+        } else {
+            return a < b;
+        }
+    }
+};
+
+// Is `price` a whole number of ticks? Floating-point prices may be off by a millionth of
+// a tick of representation error (100.01 is not exactly 10001 cents).
+template<typename PriceType>
+bool on_tick_grid(PriceType price, PriceType tick_size) noexcept {
+    if constexpr (std::is_floating_point_v<PriceType>) {
+        double ticks = static_cast<double>(price) / static_cast<double>(tick_size);
+        return std::abs(ticks - std::round(ticks)) <= 1e-6;
+    } else {
+        return price % tick_size == 0;
+    }
+}
+
 enum class OrderType : uint8_t {
     LIMIT,
     MARKET,
-    IOC // Immediate or Cancel
+    IOC,        // Immediate or Cancel: fill what crosses, cancel the rest
+    FOK,        // Fill or Kill: fill in full at or better than the limit, or reject
+    POST_ONLY,  // rest without taking liquidity; rejected if it would cross
+    STOP,       // market order once the last trade reaches the trigger
+    STOP_LIMIT  // limit order once the last trade reaches the trigger
 };
 
-struct MatchResult;
+// Dense handle for an interned client id (see IdInterner); hot records carry this
+using IdHandle = uint32_t;
+inline constexpr IdHandle NO_ID = UINT32_MAX;
+
+// Trading account for self-trade prevention; orders of one account never trade together
+using Account = uint16_t;
+inline constexpr Account NO_ACCOUNT = 0;
+
+// Client order id. Cold data: only touched at the gateway and when reporting fills,
+// so it is kept out of the hot records, which carry an interned IdHandle instead.
+struct OrderId {
+    static constexpr size_t MAX_LENGTH = 16;
+    std::array<char, MAX_LENGTH> value{};
+
+    // Zero-padded, so two ids compare and hash as 16 raw bytes
+    void set(std::string_view id_str) {
+        size_t copy_size = std::min(id_str.size(), MAX_LENGTH - 1);
+        std::copy_n(id_str.begin(), copy_size, value.begin());
+        std::fill(value.begin() + copy_size, value.end(), '\0');
+    }
+
+    std::string_view view() const {
+        return std::string_view(value.data());
+    }
+};
 
-struct alignas(16) Order {
-    static constexpr size_t MAX_ID_LENGTH = 16;
-    std::array<char, MAX_ID_LENGTH> id{};
+// Hot order record: everything the matching path reads, packed into half a cache line
+// with the 8-byte fields first so there is no internal padding. Deliberately not
+// over-aligned: std::stable_sort and friends use temporary buffers that ignore alignas.
+struct Order {
     double price;
+    uint64_t timestamp;
+    uint64_t order_id;   // exchange-assigned id (acceptance sequence number), 0 until accepted
     uint32_t quantity;
     Side side;
     OrderType type;
-    uint64_t timestamp;
-
-    void set_id(std::string_view id_str) {
-        size_t copy_size = std::min(id_str.size(), MAX_ID_LENGTH - 1);
-        std::copy_n(id_str.begin(), copy_size, id.begin());
-        id[copy_size] = '\0';
-    }
-
-    std::string_view get_id() const {
-        return std::string_view(id.data());
-    }
+    Account account;     // NO_ACCOUNT opts out of self-trade prevention
 
-    // SIMD-optimized comparison using NEON
+    // Priority comparison: true if this order ranks behind `other` on this order's side
+    // (worse price, or same price and later arrival). Exact on the double price and
+    // evaluated without branches; batches are ranked with OrderSort sort keys instead.
     bool operator<(const Order& other) const noexcept {
-        if (side == Side::BUY) {
-            float32x2_t a = vdup_n_f32(static_cast<float>(price));
-            float32x2_t b = vdup_n_f32(static_cast<float>(other.price));
-            uint32x2_t result = vclt_f32(a, b);
-            return vget_lane_u32(result, 0) != 0;
-        }
-        return price > other.price;
+        bool worse_price = (side == Side::BUY) ? (price < other.price) : (price > other.price);
+        bool later = (price == other.price) & (timestamp > other.timestamp);
+        return worse_price | later;
     }
 
     bool operator>(const Order& other) const noexcept {
@@ -57,12 +111,11 @@ struct alignas(16) Order {
     }
 };
 
-// Price level tracking with NEON SIMD
-struct alignas(16) PriceLevel {
-    double price;
+// Aggregate state of one price level. The price is the container key, so it is not
+// repeated here; eight levels share a cache line.
+struct alignas(8) PriceLevel {
     uint32_t total_quantity;
     uint32_t order_count;
-    uint32_t padding;  // Add padding for 16-byte alignment
 
     void update_quantity(int32_t delta) noexcept {
         total_quantity += delta;
@@ -70,76 +123,96 @@ struct alignas(16) PriceLevel {
     }
 };
 
-struct MatchResult {
-    uint32_t quantity;
+// Price level as reported by depth queries
+struct DepthLevel {
     double price;
-    std::array<char, Order::MAX_ID_LENGTH> counterparty_id{};
+    uint32_t total_quantity;
+    uint32_t order_count;
+};
 
-    void set_counterparty_id(std::string_view id) {
-        size_t copy_size = std::min(id.size(), Order::MAX_ID_LENGTH - 1);
-        std::copy_n(id.begin(), copy_size, counterparty_id.begin());
-        counterparty_id[copy_size] = '\0';
-    }
+// One fill. Members default to zero so partially filled-in results stay well defined.
+struct MatchResult {
+    double price = 0;
+    uint64_t sequence = 0;          // exchange sequence number of the fill
+    uint64_t order_id = 0;          // resting order's exchange id (per-order books)
+    IdHandle counterparty_id = 0;
+    uint32_t quantity = 0;
+};
+
+// Outcome of OrderBook::submit_order
+struct OrderResult {
+    uint64_t order_id = 0;   // exchange id; 0 if rejected
+    uint32_t filled = 0;
+    uint32_t resting = 0;    // quantity left on the book
+    uint32_t prevented = 0;  // removed without trading by self-trade prevention
 };
 
+static_assert(sizeof(Order) == 32, "Order must stay half a cache line");
+static_assert(offsetof(Order, quantity) == 24, "Order hot fields must not be padded");
+static_assert(sizeof(PriceLevel) == 8, "PriceLevel must pack eight to a cache line");
+static_assert(sizeof(DepthLevel) == 16, "DepthLevel must pack four to a cache line");
+static_assert(sizeof(MatchResult) == 32, "MatchResult must stay half a cache line");
+static_assert(64 % sizeof(Order) == 0 && 64 % sizeof(PriceLevel) == 0 &&
+              64 % sizeof(MatchResult) == 0, "Hot structs must not straddle cache lines");
+
 // SIMD-optimized batch operations
 struct BatchOperations {
-    static void process_quantity_updates(const std::array<PriceLevel*, 4>& levels,
-                                         const std::array<int32_t, 4>& deltas,
-                                         size_t count) {
-        // Prepare data for NEON processing
-        alignas(16) std::array<uint32_t, 4> quantities;
-        alignas(16) std::array<uint32_t, 4> counts;
-
-        // Load current values
-        for (size_t i = 0; i < count; ++i) {
-            if (levels[i]) {
-                quantities[i] = levels[i]->total_quantity;
-                counts[i] = levels[i]->order_count;
-            } else {
-                quantities[i] = 0;
-                counts[i] = 0;
-            }
-        }
-
-        // Process using NEON
-        uint32x4_t q_vec = vld1q_u32(quantities.data());
-        uint32x4_t c_vec = vld1q_u32(counts.data());
-        int32x4_t d_vec = vld1q_s32(deltas.data());
+    // Contiguous (struct-of-arrays) variant: quantities[i], counts[i] and deltas[i] describe
+    // the same level, so whole vectors are loaded and stored without gather/scatter
+    static void process_quantity_updates(uint32_t* quantities, uint32_t* counts,
+                                         const int32_t* deltas, size_t count) noexcept {
+        size_t i = 0;
+#if defined(__ARM_NEON)
         uint32x4_t one_vec = vdupq_n_u32(1);
-
-        // Update quantities and counts
-        q_vec = vaddq_u32(q_vec, vreinterpretq_u32_s32(d_vec));
-        c_vec = vaddq_u32(c_vec, one_vec);
-
-        // Store results back to arrays
-        vst1q_u32(quantities.data(), q_vec);
-        vst1q_u32(counts.data(), c_vec);
-
-        // Update price levels
-        for (size_t i = 0; i < count; ++i) {
-            if (levels[i]) {
-                levels[i]->total_quantity = quantities[i];
-                levels[i]->order_count = counts[i];
-            }
+        for (; i + 4 <= count; i += 4) {
+            uint32x4_t q_vec = vld1q_u32(quantities + i);
+            uint32x4_t c_vec = vld1q_u32(counts + i);
+            int32x4_t d_vec = vld1q_s32(deltas + i);
+            vst1q_u32(quantities + i, vaddq_u32(q_vec, vreinterpretq_u32_s32(d_vec)));
+            vst1q_u32(counts + i, vaddq_u32(c_vec, one_vec));
+        }
+#elif defined(__SSE2__)
+        __m128i one_vec = _mm_set1_epi32(1);
+        for (; i + 4 <= count; i += 4) {
+            __m128i q_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quantities + i));
+            __m128i c_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + i));
+            __m128i d_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(quantities + i), _mm_add_epi32(q_vec, d_vec));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(counts + i), _mm_add_epi32(c_vec, one_vec));
+        }
+#endif
+        for (; i < count; ++i) {
+            quantities[i] += static_cast<uint32_t>(deltas[i]);
+            counts[i] += 1;
         }
     }
 
-    // Helper method for processing individual updates
-    static void process_single_update(PriceLevel* level, int32_t delta) {
-        if (!level) return;
-
-        // Load values into NEON registers
-        uint32x2_t current = vld1_u32(&level->total_quantity);
-
-        // Create update values
-        uint32x2_t update = vcreate_u32((uint64_t)delta | ((uint64_t)1 << 32));
-
-        // Perform addition
-        uint32x2_t result = vadd_u32(current, update);
-
-        // Store results back
-        vst1_u32(&level->total_quantity, result);
+    // Contiguous variant with a per-level order count delta, for a window of levels where
+    // some slots take no order at all
+    static void process_level_updates(uint32_t* quantities, uint32_t* counts, const int32_t* quantity_deltas,
+                                      const int32_t* count_deltas, size_t count) noexcept {
+        size_t i = 0;
+#if defined(__ARM_NEON)
+        for (; i + 4 <= count; i += 4) {
+            uint32x4_t q_vec = vld1q_u32(quantities + i);
+            uint32x4_t c_vec = vld1q_u32(counts + i);
+            vst1q_u32(quantities + i, vaddq_u32(q_vec, vreinterpretq_u32_s32(vld1q_s32(quantity_deltas + i))));
+            vst1q_u32(counts + i, vaddq_u32(c_vec, vreinterpretq_u32_s32(vld1q_s32(count_deltas + i))));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= count; i += 4) {
+            __m128i q_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quantities + i));
+            __m128i c_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + i));
+            __m128i qd_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quantity_deltas + i));
+            __m128i cd_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(count_deltas + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(quantities + i), _mm_add_epi32(q_vec, qd_vec));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(counts + i), _mm_add_epi32(c_vec, cd_vec));
+        }
+#endif
+        for (; i < count; ++i) {
+            quantities[i] += static_cast<uint32_t>(quantity_deltas[i]);
+            counts[i] += static_cast<uint32_t>(count_deltas[i]);
+        }
     }
 };
 
@@ -0,0 +1,303 @@
+#ifndef HPORDERBOOK_PRICE_LEVEL_STORE_H
+#define HPORDERBOOK_PRICE_LEVEL_STORE_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "order_types.h"
+#include "simd_scan.h"
+#include "level_bitmap.h"
+
+// Struct-of-arrays price level store for a fixed tick ladder.
+// Level id i holds price base_price + i * tick_size (base_price on the tick grid); quantities,
+// counts and prices live in parallel arrays so batch updates and scans use contiguous vector
+// loads. A hierarchical bitmap of non-empty levels gives O(1) best / next-level lookups on
+// either side.
+template<typename PriceType>
+class PriceLevelStore {
+private:
+    PriceType base_price_;
+    PriceType tick_size_;
+    std::vector<uint32_t> quantities_;
+    std::vector<uint32_t> counts_;
+    std::vector<PriceType> prices_;
+    LevelBitmap occupied_;
+
+    void sync_occupied(size_t id) noexcept {
+        if (quantities_[id] != 0) {
+            occupied_.set(id);
+        } else {
+            occupied_.clear(id);
+        }
+    }
+
+public:
+    static constexpr size_t NO_LEVEL = static_cast<size_t>(-1);
+
+    PriceLevelStore(PriceType base_price, PriceType tick_size, size_t num_levels)
+            : base_price_(base_price), tick_size_(tick_size),
+              quantities_(num_levels, 0), counts_(num_levels, 0), prices_(num_levels),
+              occupied_(num_levels) {
+        if (num_levels == 0 || !(tick_size > PriceType{})) {
+            throw std::invalid_argument("PriceLevelStore needs levels and a positive tick size");
+        }
+        if constexpr (std::is_floating_point_v<PriceType>) {
+            // Whole ticks times the tick size, as the other level containers price levels
+            int64_t first_tick = std::llround(base_price_ / tick_size_);
+            for (size_t i = 0; i < num_levels; ++i) {
+                prices_[i] = static_cast<PriceType>(first_tick + static_cast<int64_t>(i)) * tick_size_;
+            }
+        } else {
+            for (size_t i = 0; i < num_levels; ++i) {
+                prices_[i] = base_price_ + static_cast<PriceType>(i) * tick_size_;
+            }
+        }
+    }
+
+    size_t size() const noexcept { return quantities_.size(); }
+    size_t occupied_levels() const noexcept { return occupied_.count(); }
+
+    // Level id for a price, or NO_LEVEL if it falls outside the ladder or between ticks
+    size_t level_id(PriceType price) const noexcept {
+        if (!on_tick_grid<PriceType>(price - base_price_, tick_size_)) return NO_LEVEL;
+        int64_t ticks;
+        if constexpr (std::is_floating_point_v<PriceType>) {
+            ticks = std::llround((price - base_price_) / tick_size_);
+        } else {
+            if (price < base_price_) return NO_LEVEL;
+            ticks = static_cast<int64_t>((price - base_price_) / tick_size_);
+        }
+        if (ticks < 0 || static_cast<size_t>(ticks) >= size()) return NO_LEVEL;
+        return static_cast<size_t>(ticks);
+    }
+
+    PriceType price(size_t id) const noexcept { return prices_[id]; }
+    uint32_t quantity(size_t id) const noexcept { return quantities_[id]; }
+    uint32_t count(size_t id) const noexcept { return counts_[id]; }
+
+    const uint32_t* quantities() const noexcept { return quantities_.data(); }
+    uint32_t* quantities() noexcept { return quantities_.data(); }
+    const uint32_t* counts() const noexcept { return counts_.data(); }
+    uint32_t* counts() noexcept { return counts_.data(); }
+    const PriceType* prices() const noexcept { return prices_.data(); }
+
+    void update(size_t id, int32_t quantity_delta, int32_t count_delta) noexcept {
+        quantities_[id] += static_cast<uint32_t>(quantity_delta);
+        counts_[id] += static_cast<uint32_t>(count_delta);
+        sync_occupied(id);
+    }
+
+    void clear(size_t id) noexcept {
+        quantities_[id] = 0;
+        counts_[id] = 0;
+        occupied_.clear(id);
+    }
+
+    // Best non-empty level for `side` (lowest ask, highest bid), or NO_LEVEL
+    size_t best_level(Side side) const noexcept {
+        return side == Side::SELL ? occupied_.first() : occupied_.last();
+    }
+
+    // Next non-empty level after `id` in priority order for `side`, or NO_LEVEL
+    size_t next_level(Side side, size_t id) const noexcept {
+        if (side == Side::SELL) return occupied_.next_set(id + 1);
+        return id == 0 ? NO_LEVEL : occupied_.prev_set(id - 1);
+    }
+
+    // New orders at arbitrary levels: one quantity delta and one order per entry
+    void apply_updates(const uint32_t* level_ids, const int32_t* deltas, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            update(level_ids[i], deltas[i], 1);
+        }
+    }
+
+    // New orders at consecutive levels first .. first + count - 1: whole-vector loads/stores
+    void apply_contiguous_updates(size_t first, const int32_t* deltas, size_t count) noexcept {
+        BatchOperations::process_quantity_updates(quantities_.data() + first,
+                                                  counts_.data() + first, deltas, count);
+        for (size_t id = first; id < first + count; ++id) sync_occupied(id);
+    }
+
+    // Orders landing anywhere in the window first .. first + count - 1: per-level quantity
+    // and order count deltas (zero where no order lands) in whole-vector loads/stores
+    void apply_window_updates(size_t first, const int32_t* quantity_deltas, const int32_t* count_deltas,
+                              size_t count) noexcept {
+        BatchOperations::process_level_updates(quantities_.data() + first, counts_.data() + first,
+                                               quantity_deltas, count_deltas, count);
+        for (size_t id = first; id < first + count; ++id) sync_occupied(id);
+    }
+
+    // Total quantity resting on levels first..last (inclusive)
+    uint64_t total_quantity(size_t first, size_t last) const noexcept {
+        if (first > last) return 0;
+        return SimdScan::sum(quantities_.data() + first, last - first + 1);
+    }
+
+    // Last level reachable from `best` without passing `limit`, walking in priority order
+    // for `side` (asks ascend, bids descend from best), clamped to the ladder; NO_LEVEL if
+    // `best` itself is beyond the limit
+    size_t limit_level(Side side, size_t best, PriceType limit) const noexcept {
+        // Fractional tick offset of the limit; asks round it down, bids round it up
+        double offset = (static_cast<double>(limit) - static_cast<double>(base_price_)) /
+                        static_cast<double>(tick_size_);
+        if (side == Side::SELL) {
+            double last = std::floor(offset + 1e-9);
+            if (last < static_cast<double>(best)) return NO_LEVEL;
+            return last >= static_cast<double>(size()) ? size() - 1 : static_cast<size_t>(last);
+        }
+        double first = std::ceil(offset - 1e-9);
+        if (first > static_cast<double>(best)) return NO_LEVEL;
+        return first < 0 ? 0 : static_cast<size_t>(first);
+    }
+
+    // Total liquidity from the best level up to and including `limit`
+    uint64_t liquidity_up_to(Side side, size_t best, PriceType limit) const noexcept {
+        size_t bound = limit_level(side, best, limit);
+        if (bound == NO_LEVEL) return 0;
+        return side == Side::SELL ? total_quantity(best, bound) : total_quantity(bound, best);
+    }
+
+    // First level in priority order from `best` holding at least min_quantity,
+    // or NO_LEVEL if no level qualifies
+    size_t first_level_with_quantity(Side side, size_t best, uint32_t min_quantity) const noexcept {
+        if (side == Side::SELL) {
+            size_t n = size() - best;
+            size_t offset = SimdScan::find_first_at_least(quantities_.data() + best, n, min_quantity);
+            return offset == n ? NO_LEVEL : best + offset;
+        }
+        size_t n = best + 1;
+        size_t offset = SimdScan::find_last_at_least(quantities_.data(), n, min_quantity);
+        return offset == n ? NO_LEVEL : offset;
+    }
+
+    // Sweep-to-fill: consume `quantity` starting at `best` in priority order for `side`.
+    // The exhaustion level is located with a vectorized prefix-sum pass, fully consumed
+    // levels are zeroed in bulk, and one fill per non-empty level is appended to `fills`.
+    // Returns the unfilled remainder.
+    uint32_t sweep(Side side, size_t best, uint32_t quantity, IdHandle aggressor_id,
+                   std::vector<MatchResult>& fills) {
+        return sweep(side, best, side == Side::SELL ? size() - 1 : 0, quantity, aggressor_id, fills);
+    }
+
+    // Sweep that stops after level `bound` in priority order (see limit_level), for
+    // orders with a limit price
+    uint32_t sweep(Side side, size_t best, size_t bound, uint32_t quantity, IdHandle aggressor_id,
+                   std::vector<MatchResult>& fills) {
+        if (quantity == 0 || best >= size()) return quantity;
+
+        // Common case: the best level alone fills the order
+        if (quantities_[best] >= quantity) {
+            MatchResult match;
+            match.price = static_cast<double>(prices_[best]);
+            match.counterparty_id = aggressor_id;
+            match.quantity = quantity;
+            fills.push_back(match);
+            quantities_[best] -= quantity;
+            if (quantities_[best] == 0) clear(best);
+            return 0;
+        }
+
+        uint64_t before = 0;
+        size_t first, last;
+        bool exhausted;
+        if (side == Side::SELL) {
+            size_t n = bound - best + 1;
+            size_t reach = SimdScan::prefix_reach(quantities_.data() + best, n, quantity, before);
+            exhausted = reach != n;
+            first = best;
+            last = exhausted ? best + reach : bound;
+        } else {
+            size_t n = best - bound + 1;
+            size_t reach = SimdScan::suffix_reach(quantities_.data() + bound, n, quantity, before);
+            exhausted = reach != n;
+            first = exhausted ? bound + reach : bound;
+            last = best;
+        }
+
+        // The partially consumed level is `last` for asks and `first` for bids
+        size_t partial = side == Side::SELL ? last : first;
+        uint32_t partial_take = exhausted ? static_cast<uint32_t>(quantity - before) : 0;
+
+        // Reserve one slot per level in range up front, then trim the empty levels
+        size_t base = fills.size();
+        fills.resize(base + (last - first + 1));
+        MatchResult* out = fills.data() + base;
+        auto emit = [&](size_t id, uint32_t taken) {
+            out->price = static_cast<double>(prices_[id]);
+            out->counterparty_id = aggressor_id;
+            out->quantity = taken;
+            out += (taken > 0);
+        };
+        if (side == Side::SELL) {
+            for (size_t id = first; id <= last; ++id) {
+                emit(id, quantities_[id]);
+            }
+        } else {
+            for (size_t id = last + 1; id-- > first;) {
+                emit(id, quantities_[id]);
+            }
+        }
+        if (exhausted) {
+            // The exhaustion level is always the last fill written
+            (out - 1)->quantity = partial_take;
+        }
+        fills.resize(static_cast<size_t>(out - fills.data()));
+
+        // Bulk-zero the fully consumed range, then settle the partial level
+        size_t zero_first = (exhausted && side == Side::BUY) ? first + 1 : first;
+        size_t zero_last = (exhausted && side == Side::SELL) ? last : last + 1;
+        std::fill(quantities_.begin() + zero_first, quantities_.begin() + zero_last, 0u);
+        std::fill(counts_.begin() + zero_first, counts_.begin() + zero_last, 0u);
+        if (zero_last > zero_first) occupied_.clear_range(zero_first, zero_last - 1);
+        if (exhausted) {
+            quantities_[partial] -= partial_take;
+            if (quantities_[partial] == 0) clear(partial);
+            return 0;
+        }
+        return static_cast<uint32_t>(quantity - before);
+    }
+};
+
+// One side of an aggregate book on a PriceLevelStore (LevelStorage::SOA_LADDER). The ladder
+// is a fixed band of ticks from the configured base price and prices outside it cannot
+// rest. The book updates and sweeps store() directly; the level-container interface here
+// serves the read paths, handing out levels by value since there is no level struct.
+template<typename PriceType, Side S>
+class SoaLevels {
+private:
+    PriceLevelStore<PriceType> store_;
+
+public:
+    SoaLevels(PriceType base_price, PriceType tick_size, size_t ticks) : store_(base_price, tick_size, ticks) {}
+
+    PriceLevelStore<PriceType>& store() noexcept { return store_; }
+    const PriceLevelStore<PriceType>& store() const noexcept { return store_; }
+
+    size_t size() const noexcept { return store_.occupied_levels(); }
+    bool empty() const noexcept { return store_.best_level(S) == PriceLevelStore<PriceType>::NO_LEVEL; }
+
+    // Best price, if the side has any level
+    bool best(PriceType& price) const noexcept {
+        size_t id = store_.best_level(S);
+        if (id == PriceLevelStore<PriceType>::NO_LEVEL) return false;
+        price = store_.price(id);
+        return true;
+    }
+
+    // Visit levels in priority order; f(price, level) returns false to stop
+    template<typename F>
+    void for_each(F&& f) const {
+        for (size_t id = store_.best_level(S); id != PriceLevelStore<PriceType>::NO_LEVEL;
+             id = store_.next_level(S, id)) {
+            if (!f(store_.price(id), PriceLevel{store_.quantity(id), store_.count(id)})) return;
+        }
+    }
+};
+
+#endif //HPORDERBOOK_PRICE_LEVEL_STORE_H
@@ -0,0 +1,41 @@
+#ifndef HPORDERBOOK_SEQUENCER_H
+#define HPORDERBOOK_SEQUENCER_H
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Exchange sequence numbers: 1, 2, 3, ... one per accepted message and per fill, giving
+// downstream consumers gap detection and a deterministic replay order.
+//
+// Only the book's single writer (the holder of its write lock, or the only thread of an
+// unlocked book) calls next(), so no read-modify-write is needed. Shared books keep the
+// counter in a relaxed atomic so last() can be read without the lock; the increment is
+// still a plain load and store. Unlocked books use a plain integer.
+template<bool Shared>
+class Sequencer {
+private:
+    std::atomic<uint64_t> last_{0};
+
+public:
+    uint64_t next() noexcept {
+        uint64_t seq = last_.load(std::memory_order_relaxed) + 1;
+        last_.store(seq, std::memory_order_release);
+        return seq;
+    }
+
+    uint64_t last() const noexcept { return last_.load(std::memory_order_acquire); }
+};
+
+template<>
+class Sequencer<false> {
+private:
+    uint64_t last_ = 0;
+
+public:
+    uint64_t next() noexcept { return ++last_; }
+    uint64_t last() const noexcept { return last_; }
+};
+
+#endif //HPORDERBOOK_SEQUENCER_H
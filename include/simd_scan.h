@@ -0,0 +1,225 @@
+#ifndef HPORDERBOOK_SIMD_SCAN_H
+#define HPORDERBOOK_SIMD_SCAN_H
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// SIMD scans over contiguous uint32_t lanes (level quantities, order quantities).
+// Each kernel has a NEON, AVX2 (8 lanes), SSE2 (4 lanes) and scalar path.
+struct SimdScan {
+    // Sum of values[0..count), widened to 64 bits so full books cannot overflow
+    static uint64_t sum(const uint32_t* values, size_t count) noexcept {
+        size_t i = 0;
+        uint64_t total = 0;
+#if defined(__ARM_NEON)
+        uint64x2_t acc = vdupq_n_u64(0);
+        for (; i + 4 <= count; i += 4) {
+            acc = vpadalq_u32(acc, vld1q_u32(values + i));
+        }
+        total = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#elif defined(__AVX2__)
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+        __m128i acc = _mm_setzero_si128();
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+            acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        total = lanes[0] + lanes[1];
+#endif
+        for (; i < count; ++i) {
+            total += values[i];
+        }
+        return total;
+    }
+
+    // Index of the first value >= threshold, or count if there is none
+    static size_t find_first_at_least(const uint32_t* values, size_t count,
+                                      uint32_t threshold) noexcept {
+        size_t i = 0;
+#if defined(__ARM_NEON)
+        uint32x4_t thr = vdupq_n_u32(threshold);
+        for (; i + 4 <= count; i += 4) {
+            if (vmaxvq_u32(vcgeq_u32(vld1q_u32(values + i), thr)) != 0) break;
+        }
+#elif defined(__AVX2__)
+        __m256i thr = _mm256_set1_epi32(static_cast<int>(threshold));
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(v, thr), v);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(ge));
+            if (mask != 0) return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+#elif defined(__SSE2__)
+        // SSE2 only has signed compares: bias both sides by 2^31
+        const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        __m128i thr = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(threshold)), bias);
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+            int below = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(thr, v)));
+            int mask = ~below & 0xF;
+            if (mask != 0) return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+#endif
+        for (; i < count; ++i) {
+            if (values[i] >= threshold) return i;
+        }
+        return count;
+    }
+
+    // Index of the last value >= threshold, or count if there is none
+    static size_t find_last_at_least(const uint32_t* values, size_t count,
+                                     uint32_t threshold) noexcept {
+        size_t end = count;
+#if defined(__ARM_NEON)
+        uint32x4_t thr = vdupq_n_u32(threshold);
+        while (end >= 4 && vmaxvq_u32(vcgeq_u32(vld1q_u32(values + end - 4), thr)) == 0) {
+            end -= 4;
+        }
+#elif defined(__AVX2__)
+        __m256i thr = _mm256_set1_epi32(static_cast<int>(threshold));
+        for (; end >= 8; end -= 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + end - 8));
+            __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(v, thr), v);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(ge));
+            if (mask != 0) return end - 8 + (31 - __builtin_clz(static_cast<unsigned>(mask)));
+        }
+#elif defined(__SSE2__)
+        const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        __m128i thr = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(threshold)), bias);
+        for (; end >= 4; end -= 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + end - 4)), bias);
+            int below = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(thr, v)));
+            int mask = ~below & 0xF;
+            if (mask != 0) return end - 4 + (31 - __builtin_clz(static_cast<unsigned>(mask)));
+        }
+#endif
+        while (end > 0) {
+            --end;
+            if (values[end] >= threshold) return end;
+        }
+        return count;
+    }
+
+    // Smallest k such that values[0..k] sums to at least target. `before` receives the sum of
+    // values[0..k). Whole blocks are skipped on vector block sums; only the block holding the
+    // exhaustion point is walked lane by lane. Returns count (before = total) if unreachable.
+    static size_t prefix_reach(const uint32_t* values, size_t count, uint64_t target,
+                               uint64_t& before) noexcept {
+        uint64_t running = 0;
+        size_t i = 0;
+        for (; i + REACH_BLOCK <= count; i += REACH_BLOCK) {
+            uint64_t block = sum(values + i, REACH_BLOCK);
+            if (running + block >= target) break;
+            running += block;
+        }
+        for (; i < count; ++i) {
+            if (running + values[i] >= target) {
+                before = running;
+                return i;
+            }
+            running += values[i];
+        }
+        before = running;
+        return count;
+    }
+
+    // Mirror of prefix_reach walking from the end: largest k such that values[k..count) sums
+    // to at least target, with `before` = sum of values(k..count). Returns count if unreachable.
+    static size_t suffix_reach(const uint32_t* values, size_t count, uint64_t target,
+                               uint64_t& before) noexcept {
+        uint64_t running = 0;
+        size_t end = count;
+        for (; end >= REACH_BLOCK; end -= REACH_BLOCK) {
+            uint64_t block = sum(values + end - REACH_BLOCK, REACH_BLOCK);
+            if (running + block >= target) break;
+            running += block;
+        }
+        while (end > 0) {
+            --end;
+            if (running + values[end] >= target) {
+                before = running;
+                return end;
+            }
+            running += values[end];
+        }
+        before = running;
+        return count;
+    }
+
+    // Running totals: out[i] = values[0] + ... + values[i], widened to 64 bits. Each vector
+    // step widens a block of lanes, adds the block to itself shifted by 1, 2, ... lanes,
+    // then adds the carry from the previous block.
+    static void inclusive_scan(const uint32_t* values, uint64_t* out, size_t count) noexcept {
+        size_t i = 0;
+        uint64_t carry = 0;
+#if defined(__ARM_NEON)
+        uint64x2_t carry_v = vdupq_n_u64(0);
+        const uint64x2_t zero = vdupq_n_u64(0);
+        for (; i + 2 <= count; i += 2) {
+            uint64x2_t v = vmovl_u32(vld1_u32(values + i));
+            v = vaddq_u64(v, vextq_u64(zero, v, 1));
+            v = vaddq_u64(v, carry_v);
+            vst1q_u64(out + i, v);
+            carry_v = vdupq_laneq_u64(v, 1);
+        }
+        carry = vgetq_lane_u64(carry_v, 0);
+#elif defined(__AVX2__)
+        __m256i carry_v = _mm256_setzero_si256();
+        for (; i + 4 <= count; i += 4) {
+            __m256i v = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+            __m256i by_one = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0));
+            v = _mm256_add_epi64(v, _mm256_blend_epi32(by_one, _mm256_setzero_si256(), 0x03));
+            v = _mm256_add_epi64(v, _mm256_permute2x128_si256(v, v, 0x08));
+            v = _mm256_add_epi64(v, carry_v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+            carry_v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        carry = static_cast<uint64_t>(_mm256_extract_epi64(carry_v, 0));
+#elif defined(__SSE2__)
+        __m128i carry_v = _mm_setzero_si128();
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 2 <= count; i += 2) {
+            __m128i v = _mm_unpacklo_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i)), zero);
+            v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi64(v, carry_v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+            carry_v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), carry_v);
+        carry = lanes[0];
+#endif
+        for (; i < count; ++i) {
+            carry += values[i];
+            out[i] = carry;
+        }
+    }
+
+private:
+    static constexpr size_t REACH_BLOCK = 16;
+};
+
+#endif //HPORDERBOOK_SIMD_SCAN_H
@@ -0,0 +1,69 @@
+#ifndef HPORDERBOOK_STOP_INDEX_H
+#define HPORDERBOOK_STOP_INDEX_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "order_types.h"
+
+// A parked stop order. On activation it is re-entered as a market order, or as a limit
+// order at `limit` for stop-limits, keeping the exchange id it was accepted under.
+struct StopOrder {
+    double trigger;
+    double limit;
+    uint64_t order_id;   // acceptance sequence number; activation order within one print
+    IdHandle id;
+    uint32_t quantity;
+    Side side;
+    OrderType type;      // STOP or STOP_LIMIT
+    Account account;
+};
+
+// Trigger index for the stops of one side, sorted by trigger price in the direction they
+// fire: buy stops fire when the last trade rises to their trigger, sell stops when it
+// falls to theirs. Stops that a print crosses are therefore always a prefix, so
+// activation pops the k crossed stops in O(k + log n) and never looks at the rest.
+// Stops at one trigger price keep arrival order.
+template<typename PriceType, Side S>
+class StopIndex {
+private:
+    // Firing order: ascending triggers for buy stops, descending for sell stops
+    using FiringOrder = std::conditional_t<S == Side::BUY, SidePriority<Side::SELL>, SidePriority<Side::BUY>>;
+
+    std::map<PriceType, std::vector<StopOrder>, FiringOrder> stops_;
+    size_t size_ = 0;
+
+public:
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    // Would a trade at `price` fire a stop at `trigger`?
+    static bool crossed(PriceType trigger, PriceType price) noexcept {
+        return !FiringOrder{}(price, trigger);
+    }
+
+    void add(const StopOrder& stop) {
+        stops_[static_cast<PriceType>(stop.trigger)].push_back(stop);
+        ++size_;
+    }
+
+    // Move every stop crossed by a trade at `price` to `out`. Returns the number moved.
+    size_t pop_crossed(PriceType price, std::vector<StopOrder>& out) {
+        size_t popped = 0;
+        auto it = stops_.begin();
+        while (it != stops_.end() && crossed(it->first, price)) {
+            out.insert(out.end(), it->second.begin(), it->second.end());
+            popped += it->second.size();
+            it = stops_.erase(it);
+        }
+        size_ -= popped;
+        return popped;
+    }
+};
+
+#endif //HPORDERBOOK_STOP_INDEX_H
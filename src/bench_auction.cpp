@@ -0,0 +1,74 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../include/order_book.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// 1M limit orders collected during a call: bids uniform in 99..101, asks in 98.5..100.5 on a
+// 0.01 tick, quantities 1..1000, so roughly half the book is crossed at the open.
+constexpr size_t AUCTION_ORDERS = 1'000'000;
+
+struct AuctionInput {
+    double price;
+    uint32_t quantity;
+    Side side;
+};
+
+std::vector<AuctionInput> make_inputs() {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> tick_dist(0, 200);
+    std::uniform_int_distribution<uint32_t> qty_dist(1, 1000);
+    std::vector<AuctionInput> inputs;
+    inputs.reserve(AUCTION_ORDERS);
+    for (size_t i = 0; i < AUCTION_ORDERS; ++i) {
+        Side side = (gen() & 1) ? Side::BUY : Side::SELL;
+        double base = side == Side::BUY ? 99.0 : 98.5;
+        inputs.push_back(AuctionInput{base + tick_dist(gen) * 0.01, qty_dist(gen), side});
+    }
+    return inputs;
+}
+
+template<typename Config>
+void run_auction(const char* name, const std::vector<AuctionInput>& inputs) {
+    auto book = std::make_unique<OrderBook<double, Config>>();
+    size_t fills = 0;
+    auto count = [&fills](const MatchResult&) { ++fills; };
+    book->begin_auction();
+    for (const auto& input : inputs) {
+        book->submit_order(input.side, OrderType::LIMIT, input.price, input.quantity, NO_ID, count);
+    }
+
+    auto start = steady_clock::now();
+    AuctionResult indicative = book->indicative_auction();
+    do_not_optimize(indicative);
+    auto equilibrium_time = steady_clock::now() - start;
+    start = steady_clock::now();
+    AuctionResult result = book->uncross(count);
+    auto uncross_time = steady_clock::now() - start;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(12) << name << std::setw(10) << std::setprecision(2) << result.price
+              << std::setw(14) << result.volume << std::setw(10) << fills
+              << std::setw(16) << std::setprecision(3) << duration<double, std::milli>(equilibrium_time).count()
+              << std::setw(14) << duration<double, std::milli>(uncross_time).count() << std::endl;
+}
+
+} // namespace
+
+void run_auction_benchmark() {
+    auto inputs = make_inputs();
+    std::cout << "Call auction uncross of " << AUCTION_ORDERS << " orders\n" << std::endl;
+    std::cout << std::setw(12) << "book" << std::setw(10) << "price" << std::setw(14) << "volume"
+              << std::setw(10) << "fills" << std::setw(16) << "equilibrium ms"
+              << std::setw(14) << "uncross ms" << std::endl;
+    run_auction<DefaultBookConfig>("aggregate", inputs);
+    run_auction<BacktestBookConfig>("per-order", inputs);
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../include/bplus_tree.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+struct ContainerTimings {
+    double insert_ns;
+    double lookup_ns;
+    double iterate_ns;   // per element
+    double erase_ns;
+};
+
+std::vector<double> shuffled_prices(size_t levels, uint32_t seed) {
+    std::vector<double> prices(levels);
+    for (size_t i = 0; i < levels; ++i) prices[i] = 1.0 + static_cast<double>(i) * 0.01;
+    std::shuffle(prices.begin(), prices.end(), std::mt19937(seed));
+    return prices;
+}
+
+template<typename Insert, typename Lookup, typename Iterate, typename Erase>
+ContainerTimings measure(const std::vector<double>& prices, const std::vector<double>& probes,
+                         Insert&& insert, Lookup&& lookup, Iterate&& iterate, Erase&& erase) {
+    auto per_op = [](auto elapsed, size_t ops) {
+        return static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) / static_cast<double>(ops);
+    };
+    ContainerTimings t{};
+
+    auto start = steady_clock::now();
+    for (double price : prices) insert(price);
+    t.insert_ns = per_op(steady_clock::now() - start, prices.size());
+
+    uint64_t checksum = 0;
+    start = steady_clock::now();
+    for (double probe : probes) checksum += lookup(probe);
+    t.lookup_ns = per_op(steady_clock::now() - start, probes.size());
+
+    size_t rounds = std::max<size_t>(1, 1'000'000 / prices.size());
+    start = steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) checksum += iterate();
+    t.iterate_ns = per_op(steady_clock::now() - start, rounds * prices.size());
+
+    start = steady_clock::now();
+    for (double price : prices) erase(price);
+    t.erase_ns = per_op(steady_clock::now() - start, prices.size());
+
+    do_not_optimize(checksum);
+    return t;
+}
+
+void print_row(const char* name, size_t levels, const ContainerTimings& t) {
+    std::cout << std::left << std::setw(12) << name << std::right << std::setw(10) << levels
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << t.insert_ns << std::setw(10) << t.erase_ns
+              << std::setw(13) << t.lookup_ns << std::setw(11) << t.iterate_ns << std::endl;
+}
+
+} // namespace
+
+void run_containers_benchmark() {
+    std::cout << "Ordered level containers (bid side), ns per operation\n" << std::endl;
+    std::cout << std::left << std::setw(12) << "container" << std::right << std::setw(10) << "levels"
+              << std::setw(10) << "insert" << std::setw(10) << "erase"
+              << std::setw(13) << "lower_bound" << std::setw(11) << "iterate" << std::endl;
+
+    for (size_t levels : {100, 10'000, 1'000'000}) {
+        auto prices = shuffled_prices(levels, 1);
+        auto probes = shuffled_prices(levels, 2);
+        for (double& p : probes) p += 0.005;
+
+        {
+            std::map<double, PriceLevel, std::greater<>> map;
+            auto t = measure(prices, probes,
+                    [&](double p) { map.try_emplace(p, PriceLevel{100, 1}); },
+                    [&](double p) { auto it = map.lower_bound(p); return it == map.end() ? 0u : it->second.total_quantity; },
+                    [&] { uint64_t sum = 0; for (const auto& [p, l] : map) sum += l.total_quantity; return sum; },
+                    [&](double p) { map.erase(p); });
+            print_row("std::map", levels, t);
+        }
+        {
+            BTreeLevels<double, Side::BUY> tree;
+            auto t = measure(prices, probes,
+                    [&](double p) { tree.try_emplace(p, PriceLevel{100, 1}); },
+                    [&](double p) { auto it = tree.lower_bound(p); return it == tree.end() ? 0u : it.value().total_quantity; },
+                    [&] { uint64_t sum = 0; for (auto it = tree.begin(); it != tree.end(); ++it) sum += it.value().total_quantity; return sum; },
+                    [&](double p) { tree.erase(p); });
+            print_row("B+tree", levels, t);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "../include/order_book.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// 10 levels of 100 resting orders of 1,000 lots each, swept by market orders of 2,000 lots.
+// Iceberg runs rest the same orders showing 50 lots at a time, so every order replenishes
+// 19 times on its way out and each market order takes many more fills.
+constexpr size_t ICEBERG_LEVELS = 10;
+constexpr size_t ORDERS_PER_LEVEL = 100;
+constexpr uint32_t ORDER_QTY = 1'000;
+constexpr uint32_t SWEEP_QTY = 2'000;
+constexpr size_t ICEBERG_ROUNDS = 20;
+
+struct IcebergResult {
+    double ns_per_order;
+    double fills_per_order;
+    double ns_per_fill;
+};
+
+IcebergResult run_sweeps(uint32_t display) {
+    auto book = std::make_unique<OrderBook<double, BacktestBookConfig>>();
+    size_t fills = 0;
+    size_t market_orders = 0;
+    auto count = [&fills](const MatchResult&) { ++fills; };
+    auto ignore = [](const MatchResult&) {};
+
+    // Handles are interned once, outside the timed loop
+    std::vector<IdHandle> ids;
+    for (size_t i = 0; i < ICEBERG_LEVELS * ORDERS_PER_LEVEL; ++i) {
+        ids.push_back(book->intern_id("MAKER" + std::to_string(i)));
+    }
+    IdHandle taker = book->intern_id("TAKER");
+
+    nanoseconds elapsed{0};
+    for (size_t round = 0; round < ICEBERG_ROUNDS; ++round) {
+        for (size_t level = 0; level < ICEBERG_LEVELS; ++level) {
+            for (size_t i = 0; i < ORDERS_PER_LEVEL; ++i) {
+                book->submit_iceberg_order(Side::SELL, 100.0 + level * 0.01, ORDER_QTY, display,
+                                           ids[level * ORDERS_PER_LEVEL + i], ignore);
+            }
+        }
+        auto start = steady_clock::now();
+        while (book->process_market_order(Side::BUY, SWEEP_QTY, taker, count) > 0) ++market_orders;
+        elapsed += duration_cast<nanoseconds>(steady_clock::now() - start);
+    }
+    double ns = static_cast<double>(elapsed.count());
+    return IcebergResult{ns / market_orders, static_cast<double>(fills) / market_orders, ns / fills};
+}
+
+} // namespace
+
+void run_iceberg_benchmark() {
+    std::cout << "Market orders of " << SWEEP_QTY << " lots against " << ICEBERG_LEVELS << " levels x "
+              << ORDERS_PER_LEVEL << " orders of " << ORDER_QTY << " lots (backtest book)\n" << std::endl;
+    std::cout << std::setw(16) << "resting orders" << std::setw(14) << "ns/order"
+              << std::setw(14) << "fills/order" << std::setw(12) << "ns/fill" << std::endl;
+
+    auto print = [](const char* name, const IcebergResult& result) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(16) << name << std::setw(14) << result.ns_per_order
+                  << std::setw(14) << result.fills_per_order << std::setw(12) << result.ns_per_fill << std::endl;
+    };
+    print("plain", run_sweeps(ORDER_QTY));
+    print("iceberg 50", run_sweeps(50));
+    print("iceberg 10", run_sweeps(10));
+}
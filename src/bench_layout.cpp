@@ -0,0 +1,71 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../include/order_book.h"
+#include "benchmarks.h"
+#include "perf_counters.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t LAYOUT_OPS = 200'000;
+constexpr int PRICE_TICKS = 2'000;
+
+void report(const char* name, size_t ops, nanoseconds elapsed, std::optional<uint64_t> misses) {
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(elapsed.count()) / ops << " ns/op";
+    if (misses) {
+        std::cout << std::setw(10) << static_cast<double>(*misses) / ops << " cache misses/op";
+    } else {
+        std::cout << "       n/a cache misses/op (perf events unavailable)";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+void run_layout_benchmark() {
+    std::cout << "Hot struct sizes (bytes):" << std::endl;
+    std::cout << "  Order:       " << sizeof(Order) << std::endl;
+    std::cout << "  PriceLevel:  " << sizeof(PriceLevel) << std::endl;
+    std::cout << "  MatchResult: " << sizeof(MatchResult) << std::endl;
+    std::cout << "  DepthLevel:  " << sizeof(DepthLevel) << "\n" << std::endl;
+
+    auto book = std::make_unique<OrderBook<double>>();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> tick_dist(0, PRICE_TICKS - 1);
+    std::uniform_int_distribution<> qty_dist(100, 1000);
+
+    std::vector<double> prices(LAYOUT_OPS);
+    std::vector<uint32_t> quantities(LAYOUT_OPS);
+    for (size_t i = 0; i < LAYOUT_OPS; ++i) {
+        prices[i] = 100.0 + tick_dist(gen) * 0.01;
+        quantities[i] = qty_dist(gen);
+    }
+
+    CacheMissCounter counter;
+
+    counter.start();
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < LAYOUT_OPS; ++i) {
+        do_not_optimize(book->add_limit_order(i % 2 ? Side::BUY : Side::SELL, prices[i], quantities[i], "LAYOUT"));
+    }
+    auto elapsed = steady_clock::now() - start;
+    report("add_limit_order", LAYOUT_OPS, duration_cast<nanoseconds>(elapsed), counter.stop());
+
+    size_t market_ops = LAYOUT_OPS / 4;
+    counter.start();
+    start = steady_clock::now();
+    for (size_t i = 0; i < market_ops; ++i) {
+        do_not_optimize(book->process_market_order(i % 2 ? Side::BUY : Side::SELL, quantities[i], "LAYOUT"));
+    }
+    elapsed = steady_clock::now() - start;
+    report("market_order", market_ops, duration_cast<nanoseconds>(elapsed), counter.stop());
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/order_book.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// Same workload as the throughput benchmark: 1M limit orders from 8 threads, prices
+// uniform in 90..110, quantities 100..1000. Inputs are generated up front so only the
+// book and its lock are timed.
+constexpr size_t LOCK_ORDERS = 1'000'000;
+constexpr size_t LOCK_THREADS = 8;
+
+struct OrderInput {
+    double price;
+    uint32_t quantity;
+    Side side;
+};
+
+template<LockPolicy P, bool Combining = false>
+struct LockBenchConfig : DefaultBookConfig {
+    static constexpr LockPolicy lock_policy = P;
+    static constexpr size_t queue_capacity = 1024;
+    static constexpr bool flat_combining = Combining;
+};
+
+std::vector<std::vector<OrderInput>> make_inputs(size_t threads) {
+    std::vector<std::vector<OrderInput>> inputs(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        std::mt19937 gen(static_cast<uint32_t>(t + 1));
+        std::uniform_real_distribution<> price_dist(90.0, 110.0);
+        std::uniform_int_distribution<uint32_t> qty_dist(100, 1000);
+        inputs[t].reserve(LOCK_ORDERS / threads);
+        for (size_t i = 0; i < LOCK_ORDERS / threads; ++i) {
+            inputs[t].push_back(OrderInput{price_dist(gen), qty_dist(gen), (gen() & 1) ? Side::BUY : Side::SELL});
+        }
+    }
+    return inputs;
+}
+
+// Orders per second with one submitting thread per input vector
+template<LockPolicy P, bool Combining = false>
+double run_workload(const std::vector<std::vector<OrderInput>>& inputs) {
+    auto book = std::make_unique<OrderBook<double, LockBenchConfig<P, Combining>>>();
+    std::vector<std::thread> threads;
+    size_t total = 0;
+    for (const auto& input : inputs) total += input.size();
+
+    auto start = steady_clock::now();
+    for (const auto& input : inputs) {
+        threads.emplace_back([&book, &input] {
+            for (const auto& order : input) {
+                do_not_optimize(book->add_limit_order(order.side, order.price, order.quantity, "LOCK"));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return static_cast<double>(total) * 1e9 / static_cast<double>(elapsed);
+}
+
+void report(const char* name, size_t threads, double rate) {
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << threads
+              << std::setw(14) << std::fixed << std::setprecision(0) << rate
+              << std::setw(12) << std::setprecision(1) << 1e9 / rate << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+} // namespace
+
+void run_locks_benchmark() {
+    std::cout << "Limit order inserts, " << LOCK_ORDERS << " orders, hardware threads: "
+              << std::thread::hardware_concurrency() << "\n" << std::endl;
+    std::cout << std::left << std::setw(16) << "lock" << std::right << std::setw(8) << "threads"
+              << std::setw(14) << "orders/sec" << std::setw(12) << "ns/order" << std::endl;
+
+    report("none", 1, run_workload<LockPolicy::NONE>(make_inputs(1)));
+
+    auto inputs = make_inputs(LOCK_THREADS);
+    report("shared_mutex", LOCK_THREADS, run_workload<LockPolicy::SHARED_MUTEX>(inputs));
+    report("spinlock", LOCK_THREADS, run_workload<LockPolicy::SPINLOCK>(inputs));
+    report("ticket", LOCK_THREADS, run_workload<LockPolicy::TICKET>(inputs));
+    report("mcs", LOCK_THREADS, run_workload<LockPolicy::MCS>(inputs));
+
+    std::cout << "\nFlat combining vs plain shared_mutex\n" << std::endl;
+    std::cout << std::left << std::setw(16) << "front end" << std::right << std::setw(8) << "threads"
+              << std::setw(14) << "orders/sec" << std::setw(12) << "ns/order" << std::endl;
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        auto sweep_inputs = make_inputs(threads);
+        report("shared_mutex", threads, run_workload<LockPolicy::SHARED_MUTEX>(sweep_inputs));
+        report("flat combining", threads, run_workload<LockPolicy::SHARED_MUTEX, true>(sweep_inputs));
+    }
+}
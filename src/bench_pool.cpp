@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "../include/node_pool.h"
+#include "../include/order_types.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t LIVE_LEVELS = 1'000;
+constexpr size_t CHURN_OPS = 500'000;
+
+// One churn op: open a level at a new price and retire an old one, as when the touch
+// moves and filled levels are erased
+template<typename Map>
+std::vector<uint32_t> churn(Map& levels) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> tick_dist(0, 1'000'000);
+    std::vector<double> live;
+    live.reserve(LIVE_LEVELS);
+    while (live.size() < LIVE_LEVELS) {
+        double price = tick_dist(gen) * 0.01;
+        if (levels.try_emplace(price, PriceLevel{100, 1}).second) live.push_back(price);
+    }
+
+    std::vector<uint32_t> samples;
+    samples.reserve(CHURN_OPS);
+    for (size_t i = 0; i < CHURN_OPS; ++i) {
+        double price = tick_dist(gen) * 0.01;
+        size_t victim = static_cast<size_t>(gen()) % live.size();
+
+        auto start = steady_clock::now();
+        bool inserted = levels.try_emplace(price, PriceLevel{100, 1}).second;
+        do_not_optimize(levels.erase(live[victim]));
+        auto elapsed = steady_clock::now() - start;
+
+        live[victim] = inserted ? price : live.back();
+        if (!inserted) live.pop_back();
+        if (live.empty()) live.push_back(levels.begin()->first);
+        samples.push_back(static_cast<uint32_t>(duration_cast<nanoseconds>(elapsed).count()));
+    }
+    return samples;
+}
+
+void report(const char* name, std::vector<uint32_t> samples) {
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) { return samples[static_cast<size_t>(p * (samples.size() - 1))]; };
+    std::cout << std::left << std::setw(18) << name << std::right
+              << std::setw(8) << pct(0.50) << std::setw(8) << pct(0.90)
+              << std::setw(8) << pct(0.99) << std::setw(9) << pct(0.999)
+              << std::setw(10) << samples.back() << std::endl;
+}
+
+} // namespace
+
+void run_pool_benchmark() {
+    std::cout << "Level churn (insert + erase), ns per op, " << LIVE_LEVELS << " live levels\n" << std::endl;
+    std::cout << std::left << std::setw(18) << "allocator" << std::right
+              << std::setw(8) << "p50" << std::setw(8) << "p90" << std::setw(8) << "p99"
+              << std::setw(9) << "p99.9" << std::setw(10) << "max" << std::endl;
+
+    {
+        std::map<double, PriceLevel> levels;
+        report("operator new", churn(levels));
+    }
+    {
+        NodePool pool(2 * LIVE_LEVELS);
+        std::pmr::map<double, PriceLevel> levels{&pool};
+        report("NodePool", churn(levels));
+    }
+}
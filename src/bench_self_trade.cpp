@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "../include/order_book.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// 10 levels of 100 resting orders of 100 lots each from 50 accounts, swept by market
+// orders of 1,000 lots. The taker's account either rests nothing (the check never fires,
+// so the runs price the inline compare alone) or owns every tenth resting order.
+constexpr size_t STP_LEVELS = 10;
+constexpr size_t ORDERS_PER_LEVEL = 100;
+constexpr uint32_t ORDER_QTY = 100;
+constexpr uint32_t SWEEP_QTY = 1'000;
+constexpr size_t STP_ROUNDS = 200;
+constexpr Account TAKER_ACCOUNT = 100;
+
+template<SelfTradePrevention P>
+struct SelfTradeBookConfig : BacktestBookConfig {
+    static constexpr SelfTradePrevention self_trade_prevention = P;
+};
+
+template<SelfTradePrevention P>
+double run_sweeps(bool own_orders) {
+    auto book = std::make_unique<OrderBook<double, SelfTradeBookConfig<P>>>();
+    size_t fills = 0;
+    auto count = [&fills](const MatchResult&) { ++fills; };
+    auto ignore = [](const MatchResult&) {};
+
+    std::vector<IdHandle> ids;
+    for (size_t i = 0; i < STP_LEVELS * ORDERS_PER_LEVEL; ++i) {
+        ids.push_back(book->intern_id("MAKER" + std::to_string(i)));
+    }
+    IdHandle taker = book->intern_id("TAKER");
+
+    nanoseconds elapsed{0};
+    size_t market_orders = 0;
+    for (size_t round = 0; round < STP_ROUNDS; ++round) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto account = static_cast<Account>(own_orders && i % 10 == 0 ? TAKER_ACCOUNT : 1 + i % 50);
+            book->submit_order(Side::SELL, OrderType::LIMIT, 100.0 + (i / ORDERS_PER_LEVEL) * 0.01,
+                               ORDER_QTY, ids[i], ignore, account);
+        }
+        auto start = steady_clock::now();
+        while (book->resting_orders() > 0) {
+            book->process_market_order(Side::BUY, SWEEP_QTY, taker, count, TAKER_ACCOUNT);
+            ++market_orders;
+        }
+        elapsed += duration_cast<nanoseconds>(steady_clock::now() - start);
+    }
+    return static_cast<double>(elapsed.count()) / market_orders;
+}
+
+} // namespace
+
+void run_self_trade_benchmark() {
+    std::cout << "Market orders of " << SWEEP_QTY << " lots against " << STP_LEVELS << " levels x "
+              << ORDERS_PER_LEVEL << " orders of " << ORDER_QTY << " lots (backtest book)\n" << std::endl;
+    std::cout << std::setw(18) << "policy" << std::setw(20) << "ns/order, no self"
+              << std::setw(22) << "ns/order, 10% self" << std::endl;
+
+    auto print = [](const char* name, double clean, double self) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(18) << name << std::setw(20) << clean << std::setw(22) << self << std::endl;
+    };
+    print("none", run_sweeps<SelfTradePrevention::NONE>(false),
+          run_sweeps<SelfTradePrevention::NONE>(true));
+    print("cancel oldest", run_sweeps<SelfTradePrevention::CANCEL_OLDEST>(false),
+          run_sweeps<SelfTradePrevention::CANCEL_OLDEST>(true));
+    print("decrement both", run_sweeps<SelfTradePrevention::DECREMENT_BOTH>(false),
+          run_sweeps<SelfTradePrevention::DECREMENT_BOTH>(true));
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/order_book.h"
+#include "../include/price_level_store.h"
+#include "benchmarks.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t SWEEP_LEVELS = 4'096;
+constexpr uint32_t LEVEL_QTY = 100;
+constexpr size_t SWEEP_ITERATIONS = 20'000;
+
+// Reference implementation: walk the ladder one level at a time
+uint32_t sweep_scalar(PriceLevelStore<double>& store, size_t best, uint32_t quantity,
+                      IdHandle aggressor, std::vector<MatchResult>& fills) {
+    for (size_t id = best; id < store.size() && quantity > 0; ++id) {
+        uint32_t available = store.quantity(id);
+        if (available == 0) continue;
+        uint32_t taken = std::min(quantity, available);
+        MatchResult match;
+        match.price = store.price(id);
+        match.quantity = taken;
+        match.counterparty_id = aggressor;
+        fills.push_back(match);
+        if (taken == available) {
+            store.clear(id);
+        } else {
+            store.update(id, -static_cast<int32_t>(taken), 0);
+        }
+        quantity -= taken;
+    }
+    return quantity;
+}
+
+void refill(PriceLevelStore<double>& store, size_t levels, const std::vector<int32_t>& deltas) {
+    store.apply_contiguous_updates(0, deltas.data(), levels);
+}
+
+template<typename Sweep>
+double time_sweeps(size_t levels, Sweep&& sweep) {
+    PriceLevelStore<double> store(100.0, 0.01, SWEEP_LEVELS);
+    std::vector<int32_t> deltas(SWEEP_LEVELS, static_cast<int32_t>(LEVEL_QTY));
+    std::vector<MatchResult> fills;
+    fills.reserve(SWEEP_LEVELS);
+    IdHandle aggressor = 0;
+    uint32_t quantity = static_cast<uint32_t>(levels) * LEVEL_QTY;
+
+    // Refill cost is measured separately and subtracted
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < SWEEP_ITERATIONS; ++i) refill(store, levels, deltas);
+    auto refill_time = steady_clock::now() - start;
+    for (size_t id = 0; id < SWEEP_LEVELS; ++id) store.clear(id);
+
+    start = steady_clock::now();
+    for (size_t i = 0; i < SWEEP_ITERATIONS; ++i) {
+        refill(store, levels, deltas);
+        fills.clear();
+        do_not_optimize(sweep(store, quantity, aggressor, fills));
+    }
+    auto total = steady_clock::now() - start;
+    return static_cast<double>(duration_cast<nanoseconds>(total - refill_time).count()) / SWEEP_ITERATIONS;
+}
+
+// The same book on an SoA ladder, whose market orders match through PriceLevelStore::sweep
+struct SoaSweepConfig : DefaultBookConfig {
+    static constexpr LevelStorage level_storage = LevelStorage::SOA_LADDER;
+    static constexpr double ladder_base_price = 100.0;
+};
+
+template<typename Config>
+double time_book_sweeps(size_t levels) {
+    auto book = std::make_unique<OrderBook<double, Config>>();
+    uint32_t quantity = static_cast<uint32_t>(levels) * LEVEL_QTY;
+    size_t iterations = SWEEP_ITERATIONS / 10;
+
+    nanoseconds elapsed{0};
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t id = 0; id < levels; ++id) {
+            book->add_limit_order(Side::SELL, 100.0 + id * 0.01, LEVEL_QTY, "MAKER");
+        }
+        auto start = steady_clock::now();
+        do_not_optimize(book->process_market_order(Side::BUY, quantity, "SWEEP"));
+        elapsed += duration_cast<nanoseconds>(steady_clock::now() - start);
+    }
+    return static_cast<double>(elapsed.count()) / iterations;
+}
+
+} // namespace
+
+void run_sweep_benchmark() {
+    std::cout << "Sweep-to-fill, ns per market order (levels of " << LEVEL_QTY << " lots)\n" << std::endl;
+    std::cout << std::setw(8) << "levels" << std::setw(14) << "simd sweep"
+              << std::setw(14) << "scalar walk" << std::setw(14) << "soa book" << std::setw(14) << "std::map" << std::endl;
+
+    for (size_t levels : {1, 10, 100}) {
+        double simd = time_sweeps(levels, [](auto& store, uint32_t qty, IdHandle id, auto& fills) {
+            return store.sweep(Side::SELL, 0, qty, id, fills);
+        });
+        double scalar = time_sweeps(levels, [](auto& store, uint32_t qty, IdHandle id, auto& fills) {
+            return sweep_scalar(store, 0, qty, id, fills);
+        });
+        double soa = time_book_sweeps<SoaSweepConfig>(levels);
+        double map = time_book_sweeps<DefaultBookConfig>(levels);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << levels << std::setw(14) << simd
+                  << std::setw(14) << scalar << std::setw(14) << soa << std::setw(14) << map << std::endl;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef HPORDERBOOK_BENCHMARKS_H
+#define HPORDERBOOK_BENCHMARKS_H
+
+#pragma once
+
+// Focused micro-benchmarks, selected by name on the order_book_main command line
+
+// Make `value` observable to the compiler so the work producing it is not optimized away,
+// without emitting a store or a branch in the timed loop
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Struct sizes and cache misses per add/match operation
+void run_layout_benchmark();
+
+// Vectorized sweep-to-fill against the scalar level walk at 1, 10 and 100 levels consumed
+void run_sweep_benchmark();
+
+// Level insert/erase churn latency distribution, std::map vs pooled std::pmr::map
+void run_pool_benchmark();
+
+// B+tree vs std::map: insert, erase, lower_bound and iteration at 100, 10k and 1M levels
+void run_containers_benchmark();
+
+// The 8-thread limit order workload under each book lock policy, then flat combining
+// against the plain mutex at 1 to 32 threads
+void run_locks_benchmark();
+
+// Market orders sweeping plain resting orders against the same liquidity held as icebergs
+void run_iceberg_benchmark();
+
+// Equilibrium search and full uncross of a 1M-order call auction
+void run_auction_benchmark();
+
+// Market sweeps with self-trade prevention off and on, with and without orders to prevent
+void run_self_trade_benchmark();
+
+#endif //HPORDERBOOK_BENCHMARKS_H
@@ -7,10 +7,27 @@
 #include <atomic>
 #include <mutex>
 
+#include <charconv>
+#include <cstring>
+
 #include "../include/order_book.h"
+#include "benchmarks.h"
 
 using namespace std::chrono;
 
+#ifndef HPOB_BUILD_TYPE
+#define HPOB_BUILD_TYPE "unknown"
+#endif
+#ifndef HPOB_BUILD_FLAGS
+#define HPOB_BUILD_FLAGS ""
+#endif
+#ifndef HPOB_BUILD_ARCH
+#define HPOB_BUILD_ARCH ""
+#endif
+#ifndef HPOB_BUILD_PGO
+#define HPOB_BUILD_PGO "OFF"
+#endif
+
 constexpr size_t NUM_ORDERS = 1'000'000;  // 1 million orders
 constexpr size_t NUM_THREADS = 8;
 constexpr double PRICE_MIN = 90.0;
@@ -40,7 +57,13 @@ void generate_orders(OrderBook<double>& book, size_t num_orders, size_t thread_i
             Side side = side_dist(gen) == 0 ? Side::BUY : Side::SELL;
             double price = price_dist(gen);
             uint32_t quantity = qty_dist(gen);
-            std::string id = "ORD_" + std::to_string(thread_id) + "_" + std::to_string(i);
+            // Format the client id in place; the book interns it only if it keeps ids
+            char id_buffer[32];
+            char* end = std::to_chars(id_buffer + 4, id_buffer + sizeof(id_buffer) - 1, thread_id).ptr;
+            *end++ = '_';
+            end = std::to_chars(end, id_buffer + sizeof(id_buffer), i).ptr;
+            std::memcpy(id_buffer, "ORD_", 4);
+            std::string_view id(id_buffer, static_cast<size_t>(end - id_buffer));
 
             if (book.add_limit_order(side, price, quantity, id)) {
                 size_t current = processed_orders.fetch_add(1) + 1;
@@ -65,6 +88,23 @@ void generate_orders(OrderBook<double>& book, size_t num_orders, size_t thread_i
     }
 }
 
+void print_build_config() {
+    std::cout << "Build: " << HPOB_BUILD_TYPE << " [" << HPOB_BUILD_FLAGS << "]" << std::endl;
+    std::cout << "  arch=" << (*HPOB_BUILD_ARCH ? HPOB_BUILD_ARCH : "generic")
+#ifdef HPOB_BUILD_LTO
+              << " lto=on"
+#else
+              << " lto=off"
+#endif
+              << " pgo=" << HPOB_BUILD_PGO
+#ifdef HPOB_BUILD_ASAN
+              << " asan=on"
+#else
+              << " asan=off"
+#endif
+              << "\n" << std::endl;
+}
+
 void run_benchmark() {
     OrderBook<double> book;
     std::vector<std::thread> threads;
@@ -91,6 +131,11 @@ void run_benchmark() {
     std::cout << "Total time: " << duration.count() / 1000.0 << " ms" << std::endl;
     std::cout << "Average latency: " << duration.count() / static_cast<double>(processed_orders)
               << " microseconds per order" << std::endl;
+    std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+              << processed_orders.load() * 1'000'000.0 / duration.count()
+              << " orders/sec (" << HPOB_BUILD_TYPE << " build)" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
 
     // Show final book state
     auto [bid, ask] = book.get_best_prices();
@@ -116,11 +161,42 @@ void run_benchmark() {
     }
 }
 
-int main() {
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [throughput|layout|sweep|pool|containers|locks|iceberg|auction|stp]" << std::endl;
+}
+
+int main(int argc, char** argv) {
     try {
+        if (argc > 1 && std::strcmp(argv[1], "throughput") != 0) {
+            print_build_config();
+            if (std::strcmp(argv[1], "layout") == 0) {
+                run_layout_benchmark();
+            } else if (std::strcmp(argv[1], "sweep") == 0) {
+                run_sweep_benchmark();
+            } else if (std::strcmp(argv[1], "pool") == 0) {
+                run_pool_benchmark();
+            } else if (std::strcmp(argv[1], "containers") == 0) {
+                run_containers_benchmark();
+            } else if (std::strcmp(argv[1], "locks") == 0) {
+                run_locks_benchmark();
+            } else if (std::strcmp(argv[1], "iceberg") == 0) {
+                run_iceberg_benchmark();
+            } else if (std::strcmp(argv[1], "auction") == 0) {
+                run_auction_benchmark();
+            } else if (std::strcmp(argv[1], "stp") == 0) {
+                run_self_trade_benchmark();
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+            return 0;
+        }
+
         std::cout << "Starting High-Performance Order Book Benchmark\n"
                   << "=============================================\n" << std::endl;
 
+        print_build_config();
+
         std::cout << "Configuration:" << std::endl;
         std::cout << "Number of orders: " << NUM_ORDERS << std::endl;
         std::cout << "Number of threads: " << NUM_THREADS << std::endl;
@@ -0,0 +1,70 @@
+#ifndef HPORDERBOOK_PERF_COUNTERS_H
+#define HPORDERBOOK_PERF_COUNTERS_H
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware cache-miss counter for the calling thread (Linux perf events).
+// On other platforms, or when the kernel refuses access, stop() returns nullopt.
+class CacheMissCounter {
+private:
+    int fd_ = -1;
+
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ != -1) close(fd_);
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const noexcept { return fd_ != -1; }
+
+    void start() noexcept {
+#if defined(__linux__)
+        if (fd_ == -1) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    std::optional<uint64_t> stop() noexcept {
+#if defined(__linux__)
+        if (fd_ == -1) return std::nullopt;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (::read(fd_, &count, sizeof(count)) != sizeof(count)) return std::nullopt;
+        return count;
+#else
+        return std::nullopt;
+#endif
+    }
+};
+
+#endif //HPORDERBOOK_PERF_COUNTERS_H
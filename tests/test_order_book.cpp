@@ -1,8 +1,16 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <future>
+#include <functional>
+#include <latch>
+#include <map>
+#include <random>
 
 #include "../include/order_book.h"
+#include "../include/order_sort.h"
+#include "../include/id_interner.h"
+#include "../include/conflated_publisher.h"
+#include "../include/epoch.h"
 
 class OrderBookTest : public ::testing::Test {
 protected:
@@ -136,6 +144,1115 @@ ASSERT_FALSE(bid_depth.empty());
 ASSERT_FALSE(ask_depth.empty());
 }
 
+// Order priority comparison is exact and symmetric between sides
+TEST(OrderPriorityTest, ExactComparison) {
+Order a{}, b{};
+a.side = b.side = Side::BUY;
+a.price = 100.00000001;  // indistinguishable from b.price as a float
+b.price = 100.0;
+EXPECT_TRUE(b < a);
+EXPECT_FALSE(a < b);
+
+a.side = b.side = Side::SELL;
+EXPECT_TRUE(a < b);
+EXPECT_FALSE(b < a);
+
+// Same price: earlier arrival has priority
+a.price = b.price = 100.0;
+a.timestamp = 10;
+b.timestamp = 20;
+EXPECT_TRUE(b < a);
+EXPECT_FALSE(a < b);
+}
+
+// Batch priority sort: bids best-first, then asks best-first, FIFO within a price
+TEST(OrderPriorityTest, BatchSort) {
+auto make = [](Side side, double price, uint64_t ts) {
+    Order order{};
+    order.side = side;
+    order.price = price;
+    order.timestamp = ts;
+    return order;
+};
+
+// Wide arrival spreads leave no room to fold the batch index into the key
+for (uint64_t spread : {uint64_t{1}, uint64_t{1} << 24})
+for (size_t n : {7, 16, 40}) {
+    std::vector<Order> orders;
+    for (size_t i = 0; i < n; ++i) {
+        Side side = (i % 3 == 0) ? Side::SELL : Side::BUY;
+        orders.push_back(make(side, 100.0 + static_cast<double>((i * 7) % 5) * 0.01, 1'000 + (n - i) * spread));
+    }
+    std::vector<Order> expected = orders;
+    std::stable_sort(expected.begin(), expected.end(), [](const Order& a, const Order& b) {
+        if (a.side != b.side) return a.side == Side::BUY;
+        return b < a;
+    });
+
+    OrderSort::sort_by_priority(orders, 0.01);
+    ASSERT_EQ(orders.size(), expected.size());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(orders[i].side, expected[i].side);
+        EXPECT_EQ(orders[i].price, expected[i].price);
+        EXPECT_EQ(orders[i].timestamp, expected[i].timestamp);
+    }
+}
+
+// Off-grid prices take the exact fallback and still sort correctly
+std::vector<Order> off_grid{make(Side::SELL, 100.005, 1), make(Side::SELL, 100.001, 2)};
+OrderSort::sort_by_priority(off_grid, 0.01);
+EXPECT_EQ(off_grid[0].price, 100.001);
+}
+
+// The vector network sorts unsigned keys, including ones with the top bit set
+template<size_t N>
+void check_sort_network(std::mt19937_64& rng) {
+    for (int round = 0; round < 200; ++round) {
+        std::array<uint64_t, N> keys;
+        for (size_t i = 0; i < N; ++i) keys[i] = (rng() & ~uint64_t{0xF}) | i;
+        if (round % 2) keys[round % N] = std::numeric_limits<uint64_t>::max();
+        std::array<uint64_t, N> expected = keys;
+        std::sort(expected.begin(), expected.end());
+        OrderSort::sort_network<N>(keys.data());
+        ASSERT_EQ(keys, expected);
+    }
+}
+
+TEST(OrderPriorityTest, SortNetworkMatchesStdSort) {
+std::mt19937_64 rng(7);
+check_sort_network<2>(rng);
+check_sort_network<4>(rng);
+check_sort_network<8>(rng);
+check_sort_network<16>(rng);
+}
+
+// The same behaviour from every level container, tracking mode and lock policy
+struct SmallQueueConfig : DefaultBookConfig {
+    static constexpr size_t queue_capacity = 1024;
+};
+struct SpinLadderConfig : SmallQueueConfig {
+    static constexpr LockPolicy lock_policy = LockPolicy::SPINLOCK;
+    static constexpr LevelStorage level_storage = LevelStorage::LADDER;
+};
+struct McsMapConfig : SmallQueueConfig {
+    static constexpr LockPolicy lock_policy = LockPolicy::MCS;
+};
+struct CombiningPerOrderConfig : SmallQueueConfig {
+    static constexpr OrderTracking order_tracking = OrderTracking::PER_ORDER;
+    static constexpr bool flat_combining = true;
+};
+struct NoLockBTreeConfig : SmallQueueConfig {
+    static constexpr LockPolicy lock_policy = LockPolicy::NONE;
+    static constexpr LevelStorage level_storage = LevelStorage::BTREE;
+    static constexpr size_t batch_width = 8;
+};
+struct PerOrderMapConfig : SmallQueueConfig {
+    static constexpr OrderTracking order_tracking = OrderTracking::PER_ORDER;
+};
+struct PerOrderBTreeConfig : PerOrderMapConfig {
+    static constexpr LevelStorage level_storage = LevelStorage::BTREE;
+};
+struct SoaLadderConfig : SmallQueueConfig {
+    static constexpr LevelStorage level_storage = LevelStorage::SOA_LADDER;
+    static constexpr double ladder_base_price = 90.0;
+};
+
+template<typename Config>
+class OrderBookConfigTest : public ::testing::Test {
+protected:
+    OrderBook<double, Config> book;
+};
+
+using BookConfigs = ::testing::Types<SmallQueueConfig, SpinLadderConfig, McsMapConfig, CombiningPerOrderConfig, NoLockBTreeConfig,
+                                     PerOrderMapConfig, PerOrderBTreeConfig, SoaLadderConfig, BacktestBookConfig>;
+TYPED_TEST_SUITE(OrderBookConfigTest, BookConfigs);
+
+TYPED_TEST(OrderBookConfigTest, MatchesBestPriceFirst) {
+auto& book = this->book;
+ASSERT_TRUE(book.add_limit_order(Side::BUY, 99.0, 300, "B1"));
+ASSERT_TRUE(book.add_limit_order(Side::BUY, 99.5, 200, "B2"));
+ASSERT_TRUE(book.add_limit_order(Side::BUY, 99.5, 100, "B3"));
+ASSERT_TRUE(book.add_limit_order(Side::SELL, 101.0, 500, "S1"));
+ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.5, 500, "S2"));
+
+auto [bid, ask] = book.get_best_prices();
+EXPECT_EQ(bid, 99.5);
+EXPECT_EQ(ask, 100.5);
+
+auto bids = book.get_depth(Side::BUY, 5);
+ASSERT_EQ(bids.size(), 2u);
+EXPECT_EQ(bids[0].price, 99.5);
+EXPECT_EQ(bids[0].total_quantity, 300u);
+EXPECT_EQ(bids[0].order_count, 2u);
+
+// Aggregate fills report the aggressor, so the gateway interns the ids it wants named
+size_t interned = book.interned_ids();
+IdHandle aggressor = book.intern_id("M1");
+EXPECT_EQ(book.intern_id("M1"), aggressor);
+std::vector<MatchResult> fills;
+uint32_t filled = book.process_market_order(Side::SELL, 450, "M1",
+                                            [&](const MatchResult& m) { fills.push_back(m); });
+EXPECT_EQ(filled, 450u);
+ASSERT_FALSE(fills.empty());
+EXPECT_EQ(fills.front().price, 99.5);
+EXPECT_EQ(fills.back().price, 99.0);
+if constexpr (OrderBook<double, TypeParam>::PER_ORDER) {
+    // Resting orders fill in time priority and report their own ids
+    ASSERT_EQ(fills.size(), 3u);
+    EXPECT_EQ(book.id_name(fills[0].counterparty_id).view(), "B2");
+    EXPECT_EQ(book.id_name(fills[1].counterparty_id).view(), "B3");
+    EXPECT_EQ(fills[2].quantity, 150u);
+    EXPECT_EQ(book.resting_orders(), 3u);
+} else {
+    for (const MatchResult& fill : fills) EXPECT_EQ(fill.counterparty_id, aggressor);
+}
+
+std::tie(bid, ask) = book.get_best_prices();
+EXPECT_EQ(bid, 99.0);
+bids = book.get_depth(Side::BUY, 5);
+ASSERT_EQ(bids.size(), 1u);
+EXPECT_EQ(bids[0].total_quantity, 150u);
+
+filled = book.process_market_order(Side::BUY, 2000, "M2", [](const MatchResult&) {});
+EXPECT_EQ(filled, 1000u);
+EXPECT_TRUE(book.get_depth(Side::SELL).empty());
+// An aggressor id the gateway did not intern is looked up, not added
+EXPECT_EQ(book.interned_ids(), interned + 1);
+}
+
+// Each order type's acceptance and matching rules through submit_order
+TYPED_TEST(OrderBookConfigTest, OrderTypes) {
+auto& book = this->book;
+auto ignore = [](const MatchResult&) {};
+book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+book.add_limit_order(Side::SELL, 100.5, 100, "S2");
+book.add_limit_order(Side::BUY, 99.0, 100, "B1");
+
+// POST_ONLY: one BBO comparison
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::POST_ONLY, 100.0, 10, "P1", ignore).order_id, 0u);
+OrderResult posted = book.submit_order(Side::BUY, OrderType::POST_ONLY, 99.5, 10, "P2", ignore);
+EXPECT_NE(posted.order_id, 0u);
+EXPECT_EQ(posted.resting, 10u);
+
+// FOK: rejected without touching the book if the limit caps available liquidity
+uint64_t before = book.last_sequence();
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::FOK, 100.0, 150, "F1", ignore).order_id, 0u);
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::FOK, 101.0, 500, "F2", ignore).order_id, 0u);
+EXPECT_EQ(book.last_sequence(), before);
+OrderResult fok = book.submit_order(Side::BUY, OrderType::FOK, 100.5, 150, "F3", ignore);
+EXPECT_EQ(fok.filled, 150u);
+
+// Stop types only enter through submit_stop_order
+before = book.last_sequence();
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::STOP, 100.5, 10, "T1", ignore).order_id, 0u);
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::STOP_LIMIT, 100.5, 10, "T2", ignore).order_id, 0u);
+EXPECT_EQ(book.last_sequence(), before);
+
+// IOC: fills what crosses at the limit and drops the rest
+OrderResult ioc = book.submit_order(Side::BUY, OrderType::IOC, 100.5, 80, "I1", ignore);
+EXPECT_EQ(ioc.filled, 50u);
+EXPECT_EQ(ioc.resting, 0u);
+EXPECT_EQ(book.get_best_prices().second, 0.0);
+
+// LIMIT: a crossing sell trades the best bids, then rests its remainder
+OrderResult limit = book.submit_order(Side::SELL, OrderType::LIMIT, 99.0, 150, "L1", ignore);
+EXPECT_EQ(limit.filled, 110u);
+EXPECT_EQ(limit.resting, 40u);
+auto [bid, ask] = book.get_best_prices();
+EXPECT_EQ(bid, 0.0);
+EXPECT_EQ(ask, 99.0);
+}
+
+struct StopOrderConfig : PerOrderMapConfig {
+    static constexpr bool stop_orders = true;
+    static constexpr bool l2_feed = true;
+};
+
+TEST(StopOrderTest, CrossedStopsFireInAcceptanceOrder) {
+OrderBook<double, StopOrderConfig> book;
+std::vector<MatchResult> fills;
+auto record = [&](const MatchResult& m) { fills.push_back(m); };
+book.add_limit_order(Side::SELL, 100.0, 50, "S1");
+book.add_limit_order(Side::SELL, 101.0, 50, "S2");
+book.add_limit_order(Side::SELL, 102.0, 100, "S3");
+book.add_limit_order(Side::BUY, 99.0, 100, "B1");
+book.add_limit_order(Side::BUY, 98.0, 100, "B2");
+
+uint64_t first = book.submit_stop_order(Side::BUY, 101.0, 0.0, 30, "T1", record).order_id;
+uint64_t second = book.submit_stop_order(Side::BUY, 100.5, 101.0, 20, "T2", record).order_id;
+EXPECT_LT(first, second);
+EXPECT_EQ(book.parked_stops(), 2u);
+
+// The print at 101 crosses both triggers; T1 fires first, then the stop-limit T2
+EXPECT_EQ(book.process_market_order(Side::BUY, 60, "M1", record), 60u);
+EXPECT_EQ(book.parked_stops(), 0u);
+ASSERT_EQ(fills.size(), 4u);
+EXPECT_EQ(fills[2].quantity, 30u);
+EXPECT_EQ(fills[3].quantity, 10u);
+auto bids = book.get_depth(Side::BUY, 1);
+ASSERT_EQ(bids.size(), 1u);
+EXPECT_EQ(bids[0].price, 101.0);
+EXPECT_EQ(bids[0].total_quantity, 10u);
+
+// A sell stop waits until the last trade falls to its trigger
+book.submit_stop_order(Side::SELL, 98.5, 0.0, 150, "T3", record);
+book.process_market_order(Side::SELL, 110, "M2", record);
+EXPECT_EQ(book.parked_stops(), 1u);
+fills.clear();
+EXPECT_EQ(book.submit_order(Side::SELL, OrderType::IOC, 98.0, 10, "I1", record).filled, 10u);
+EXPECT_EQ(book.parked_stops(), 0u);
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_EQ(fills[1].quantity, 90u);
+EXPECT_TRUE(book.get_depth(Side::BUY).empty());
+}
+
+// A parked stop holds its client id, and a fired stop-limit rests after its fills
+TEST(StopOrderTest, ParkedIdsAreReservedAndActivationIsSequenced) {
+OrderBook<double, StopOrderConfig> book;
+auto ignore = [](const MatchResult&) {};
+book.add_limit_order(Side::SELL, 100.0, 50, "S1");
+ASSERT_TRUE(book.submit_stop_order(Side::BUY, 100.0, 100.0, 80, "T1", ignore).order_id);
+EXPECT_FALSE(book.add_limit_order(Side::BUY, 90.0, 10, "T1"));
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::LIMIT, 90.0, 10, "T1", ignore).order_id, 0u);
+EXPECT_EQ(book.submit_stop_order(Side::SELL, 90.0, 0.0, 10, "T1", ignore).order_id, 0u);
+ASSERT_TRUE(book.submit_stop_order(Side::BUY, 100.0, 0.0, 10, "T2", ignore).order_id);
+
+auto reader = book.l2_feed().reader();
+// The print at 100 fires T1 (30 left of the ask after M1) then T2, which finds nothing
+EXPECT_EQ(book.process_market_order(Side::BUY, 20, "M1", ignore), 20u);
+EXPECT_EQ(book.parked_stops(), 0u);
+EXPECT_EQ(book.resting_orders(), 1u);
+auto bids = book.get_depth(Side::BUY, 1);
+ASSERT_EQ(bids.size(), 1u);
+EXPECT_EQ(bids[0].total_quantity, 50u);
+L2Update update;
+std::vector<L2Update> updates;
+while (reader.poll(update) == OrderBook<double, StopOrderConfig>::L2Feed::ReadStatus::OK) updates.push_back(update);
+for (size_t i = 1; i < updates.size(); ++i) EXPECT_GT(updates[i].sequence, updates[i - 1].sequence);
+EXPECT_EQ(updates.back().side, Side::BUY);
+EXPECT_EQ(updates.back().sequence, book.last_sequence());
+
+// T1 now rests under its id; T2 fired as a market order and released its id
+EXPECT_FALSE(book.add_limit_order(Side::BUY, 90.0, 10, "T1"));
+EXPECT_TRUE(book.add_limit_order(Side::BUY, 90.0, 10, "T2"));
+}
+
+TEST(IcebergTest, ReplenishedSliceJoinsTheBackOfTheQueue) {
+OrderBook<double, PerOrderMapConfig> book;
+std::vector<MatchResult> fills;
+auto record = [&](const MatchResult& m) { fills.push_back(m); };
+OrderResult iceberg = book.submit_iceberg_order(Side::SELL, 100.0, 100, 20, "ICE", record);
+EXPECT_EQ(iceberg.resting, 100u);
+book.add_limit_order(Side::SELL, 100.0, 30, "S2");
+
+// Only the displayed slice is visible
+auto asks = book.get_depth(Side::SELL, 1);
+ASSERT_EQ(asks.size(), 1u);
+EXPECT_EQ(asks[0].total_quantity, 50u);
+EXPECT_EQ(asks[0].order_count, 2u);
+
+// The first slice fills, the next one queues behind S2
+book.process_market_order(Side::BUY, 25, "M1", record);
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_EQ(fills[0].order_id, iceberg.order_id);
+EXPECT_EQ(fills[1].quantity, 5u);
+EXPECT_EQ(book.get_depth(Side::SELL, 1)[0].total_quantity, 45u);
+EXPECT_EQ(book.get_depth(Side::SELL, 1)[0].order_count, 2u);
+
+fills.clear();
+book.process_market_order(Side::BUY, 30, "M2", record);
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_EQ(fills[0].quantity, 25u);
+EXPECT_EQ(fills[1].order_id, iceberg.order_id);
+
+// The reserve keeps replenishing until it runs out
+EXPECT_EQ(book.process_market_order(Side::BUY, 1000, "M3", record), 75u);
+EXPECT_TRUE(book.get_depth(Side::SELL).empty());
+EXPECT_EQ(book.resting_orders(), 0u);
+}
+
+// An FOK over many levels fills the levels its check collected; emptied levels go at the end
+TYPED_TEST(OrderBookConfigTest, FokFillsTheCheckedLevels) {
+auto& book = this->book;
+for (int i = 0; i < 60; ++i) {
+    ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.0 + 0.01 * i, 10, "S" + std::to_string(i)));
+}
+uint64_t before = book.last_sequence();
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::FOK, 100.3, 320, "F1", [](const MatchResult&) {}).order_id, 0u);
+EXPECT_EQ(book.last_sequence(), before);
+
+std::vector<MatchResult> fills;
+OrderResult fok = book.submit_order(Side::BUY, OrderType::FOK, 100.5, 455, "F2",
+                                    [&](const MatchResult& m) { fills.push_back(m); });
+EXPECT_EQ(fok.filled, 455u);
+EXPECT_EQ(fills.size(), 46u);
+auto asks = book.get_depth(Side::SELL, 100);
+ASSERT_EQ(asks.size(), 15u);
+EXPECT_DOUBLE_EQ(asks[0].price, 100.45);
+EXPECT_EQ(asks[0].total_quantity, 5u);
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::FOK, 101.0, 146, "F3", [](const MatchResult&) {}).order_id, 0u);
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::FOK, 101.0, 145, "F4", [](const MatchResult&) {}).filled, 145u);
+EXPECT_TRUE(book.get_depth(Side::SELL).empty());
+}
+
+TYPED_TEST(OrderBookConfigTest, AuctionUncrossesAtMaximumVolume) {
+auto& book = this->book;
+std::vector<MatchResult> fills;
+auto record = [&](const MatchResult& m) { fills.push_back(m); };
+book.begin_auction();
+EXPECT_TRUE(book.in_auction());
+EXPECT_NE(book.submit_order(Side::BUY, OrderType::LIMIT, 101.0, 100, "B1", record).order_id, 0u);
+book.submit_order(Side::BUY, OrderType::LIMIT, 100.0, 200, "B2", record);
+book.submit_order(Side::BUY, OrderType::LIMIT, 99.0, 300, "B3", record);
+book.submit_order(Side::SELL, OrderType::LIMIT, 98.0, 150, "S1", record);
+book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 200, "S2", record);
+book.add_limit_order(Side::SELL, 102.0, 100, "S3");
+
+// Nothing trades during the call
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::IOC, 102.0, 10, "I1", record).order_id, 0u);
+EXPECT_EQ(book.process_market_order(Side::BUY, 10, "M1", record), 0u);
+EXPECT_TRUE(fills.empty());
+
+// 300 lots trade at 100: bids at or above 100 total 300, asks at or below total 350
+AuctionResult indicative = book.indicative_auction();
+EXPECT_EQ(indicative.price, 100.0);
+EXPECT_EQ(indicative.volume, 300u);
+EXPECT_EQ(indicative.imbalance, -50);
+
+AuctionResult result = book.uncross(record);
+EXPECT_EQ(result.volume, 300u);
+EXPECT_FALSE(book.in_auction());
+uint64_t traded = 0;
+for (const MatchResult& fill : fills) {
+    EXPECT_EQ(fill.price, 100.0);
+    traded += fill.quantity;
+}
+EXPECT_EQ(traded, 600u);  // both sides
+auto [bid, ask] = book.get_best_prices();
+EXPECT_EQ(bid, 99.0);
+EXPECT_EQ(ask, 100.0);
+EXPECT_EQ(book.get_depth(Side::SELL, 1)[0].total_quantity, 50u);
+}
+
+template<Allocation A, uint32_t MinAllocation = 1>
+struct AllocationConfig : PerOrderMapConfig {
+    static constexpr Allocation allocation = A;
+    static constexpr uint32_t pro_rata_min_allocation = MinAllocation;
+};
+
+template<typename Config>
+std::vector<uint32_t> allocate(std::initializer_list<uint32_t> resting, uint32_t quantity) {
+    OrderBook<double, Config> book;
+    for (uint32_t size : resting) book.add_limit_order(Side::SELL, 100.0, size, NO_ID);
+    std::map<uint64_t, uint32_t> by_order;
+    book.process_market_order(Side::BUY, quantity, NO_ID, [&](const MatchResult& m) { by_order[m.order_id] += m.quantity; });
+    std::vector<uint32_t> fills;
+    for (uint64_t order_id = 1; order_id <= resting.size(); ++order_id) fills.push_back(by_order[order_id]);
+    return fills;
+}
+
+TEST(AllocationTest, ProRataSharesAPartialLevel) {
+using Fills = std::vector<uint32_t>;
+EXPECT_EQ(allocate<AllocationConfig<Allocation::FIFO>>({100, 300, 600}, 500), (Fills{100, 300, 100}));
+EXPECT_EQ(allocate<AllocationConfig<Allocation::PRO_RATA>>({100, 300, 600}, 500), (Fills{50, 150, 300}));
+// Rounding remainder goes in time priority
+EXPECT_EQ(allocate<AllocationConfig<Allocation::PRO_RATA>>({100, 300, 600}, 7), (Fills{1, 2, 4}));
+// The top order fills first, then 400 lots pro-rata over 900
+EXPECT_EQ(allocate<AllocationConfig<Allocation::FIFO_PRO_RATA>>({100, 300, 600}, 500), (Fills{100, 134, 266}));
+// Shares under the minimum fall through to time priority
+EXPECT_EQ((allocate<AllocationConfig<Allocation::PRO_RATA, 100>>({10, 990}, 50)), (Fills{10, 40}));
+
+// The queue stays intact for the next fill
+OrderBook<double, AllocationConfig<Allocation::PRO_RATA>> book;
+book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+book.add_limit_order(Side::SELL, 100.0, 100, "S2");
+book.process_market_order(Side::BUY, 150, "M1", [](const MatchResult&) {});
+EXPECT_EQ(book.resting_orders(), 2u);
+EXPECT_EQ(book.get_depth(Side::SELL, 1)[0].total_quantity, 50u);
+EXPECT_TRUE(book.cancel_order("S2"));
+EXPECT_EQ(book.process_market_order(Side::BUY, 100, "M2", [](const MatchResult&) {}), 25u);
+EXPECT_EQ(book.resting_orders(), 0u);
+}
+
+template<SelfTradePrevention P, Allocation A = Allocation::FIFO>
+struct SelfTradeConfig : PerOrderMapConfig {
+    static constexpr SelfTradePrevention self_trade_prevention = P;
+    static constexpr Allocation allocation = A;
+};
+
+// Asks of 100 lots from accounts 7, 8 and 7 at one price, then a buy for 250 from account 7
+template<typename Config>
+OrderResult self_trade(OrderBook<double, Config>& book) {
+    auto ignore = [](const MatchResult&) {};
+    book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 100, "S1", ignore, 7);
+    book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 100, "S2", ignore, 8);
+    book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 100, "S3", ignore, 7);
+    return book.submit_order(Side::BUY, OrderType::LIMIT, 100.0, 250, "B1", ignore, 7);
+}
+
+TEST(SelfTradeTest, PoliciesInTheMatchLoop) {
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::NONE>> none;
+OrderResult result = self_trade(none);
+EXPECT_EQ(result.filled, 250u);
+EXPECT_EQ(result.prevented, 0u);
+
+// Both own orders are cancelled; the rest of the buy rests
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::CANCEL_OLDEST>> oldest;
+result = self_trade(oldest);
+EXPECT_EQ(result.filled, 100u);
+EXPECT_EQ(result.resting, 150u);
+EXPECT_TRUE(oldest.get_depth(Side::SELL, 1).empty());
+EXPECT_EQ(oldest.resting_orders(), 1u);
+
+// The buy meets S1 first and is cancelled whole
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::CANCEL_NEWEST>> newest;
+result = self_trade(newest);
+EXPECT_EQ(result.filled, 0u);
+EXPECT_EQ(result.prevented, 250u);
+EXPECT_EQ(result.resting, 0u);
+EXPECT_EQ(newest.get_depth(Side::SELL, 1)[0].total_quantity, 300u);
+
+// S1 and the buy lose 100, S2 trades 100, S3 and the buy lose the last 50
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::DECREMENT_BOTH>> both;
+result = self_trade(both);
+EXPECT_EQ(result.filled, 100u);
+EXPECT_EQ(result.prevented, 150u);
+EXPECT_EQ(result.resting, 0u);
+auto asks = both.get_depth(Side::SELL, 1);
+ASSERT_EQ(asks.size(), 1u);
+EXPECT_EQ(asks[0].total_quantity, 50u);
+EXPECT_EQ(asks[0].order_count, 1u);
+// Orders without an account always trade
+EXPECT_EQ(both.process_market_order(Side::BUY, 50, "M1", [](const MatchResult&) {}), 50u);
+EXPECT_EQ(both.resting_orders(), 0u);
+
+// Pro-rata levels resolve own orders before sharing, leaving S2 to fill
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::CANCEL_OLDEST, Allocation::PRO_RATA>> pro_rata;
+result = self_trade(pro_rata);
+EXPECT_EQ(result.filled, 100u);
+EXPECT_EQ(result.resting, 150u);
+}
+
+// FOK under self-trade prevention counts only liquidity it can trade, so it never part-fills
+template<typename Config>
+OrderResult self_trade_fok(OrderBook<double, Config>& book, uint32_t quantity) {
+    auto ignore = [](const MatchResult&) {};
+    book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 100, "S1", ignore, 8);
+    book.submit_order(Side::SELL, OrderType::LIMIT, 100.0, 100, "S2", ignore, 7);
+    book.submit_order(Side::SELL, OrderType::LIMIT, 101.0, 100, "S3", ignore, 8);
+    return book.submit_order(Side::BUY, OrderType::FOK, 101.0, quantity, "F1", ignore, 7);
+}
+
+TEST(SelfTradeTest, FokCountsOnlyTradableLiquidity) {
+// S2 is cancelled, not traded: 200 lots are available, not 300
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::CANCEL_OLDEST>> oldest;
+EXPECT_EQ(self_trade_fok(oldest, 250).order_id, 0u);
+EXPECT_EQ(oldest.resting_orders(), 3u);
+OrderResult result = oldest.submit_order(Side::BUY, OrderType::FOK, 101.0, 200, "F2", [](const MatchResult&) {}, 7);
+EXPECT_EQ(result.filled, 200u);
+EXPECT_EQ(result.prevented, 0u);
+EXPECT_EQ(oldest.resting_orders(), 0u);
+
+// S2 would cut the aggressor short unless S1 alone completes the fill
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::CANCEL_NEWEST>> newest;
+EXPECT_EQ(self_trade_fok(newest, 150).order_id, 0u);
+EXPECT_EQ(newest.resting_orders(), 3u);
+EXPECT_EQ(newest.submit_order(Side::BUY, OrderType::FOK, 101.0, 100, "F2", [](const MatchResult&) {}, 7).filled,
+          100u);
+
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::DECREMENT_BOTH>> both;
+EXPECT_EQ(self_trade_fok(both, 150).order_id, 0u);
+EXPECT_EQ(both.get_depth(Side::SELL, 1)[0].total_quantity, 200u);
+
+// A pro-rata level meets its own orders before sharing, wherever they queue
+OrderBook<double, SelfTradeConfig<SelfTradePrevention::DECREMENT_BOTH, Allocation::PRO_RATA>> pro_rata;
+EXPECT_EQ(self_trade_fok(pro_rata, 50).order_id, 0u);
+EXPECT_EQ(pro_rata.resting_orders(), 3u);
+}
+
+// Ids intern to dense handles; per-order books cancel by handle and reject live duplicates
+TEST(IdInterningTest, HandlesAndCancels) {
+IdInterner interner(4);
+IdHandle a = interner.intern("ALPHA");
+IdHandle b = interner.intern("BRAVO");
+EXPECT_EQ(a, 0u);
+EXPECT_EQ(b, 1u);
+EXPECT_EQ(interner.intern("ALPHA"), a);
+EXPECT_EQ(interner.find("CHARLIE"), NO_ID);
+for (int i = 0; i < 1000; ++i) interner.intern("ID" + std::to_string(i));
+EXPECT_EQ(interner.find("ID999"), 1001u);
+EXPECT_EQ(interner.name(b).view(), "BRAVO");
+
+OrderBook<double, PerOrderMapConfig> book;
+IdHandle first = book.intern_id("FIRST");
+ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.0, 100, first));
+ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.0, 200, "SECOND"));
+ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.0, 300, "THIRD"));
+EXPECT_FALSE(book.add_limit_order(Side::SELL, 101.0, 100, first));
+EXPECT_FALSE(book.add_limit_order(Side::SELL, 101.0, 0, "EMPTY"));
+
+EXPECT_TRUE(book.cancel_order(first));
+EXPECT_FALSE(book.cancel_order(first));
+EXPECT_TRUE(book.cancel_order("THIRD"));
+EXPECT_FALSE(book.cancel_order("UNKNOWN"));
+auto asks = book.get_depth(Side::SELL, 1);
+ASSERT_EQ(asks.size(), 1u);
+EXPECT_EQ(asks[0].total_quantity, 200u);
+EXPECT_EQ(asks[0].order_count, 1u);
+EXPECT_EQ(book.resting_orders(), 1u);
+
+// Cancelled orders are skipped when matching
+auto fills = book.process_market_order(Side::BUY, 500, "TAKER");
+ASSERT_EQ(fills.size(), 1u);
+EXPECT_EQ(book.id_name(fills[0].counterparty_id).view(), "SECOND");
+EXPECT_EQ(fills[0].quantity, 200u);
+EXPECT_EQ(book.resting_orders(), 0u);
+
+// A filled id can rest again
+EXPECT_TRUE(book.add_limit_order(Side::SELL, 100.0, 100, first));
+EXPECT_TRUE(book.cancel_order(first));
+EXPECT_TRUE(book.get_depth(Side::SELL).empty());
+
+// Ids that never rest are looked up, not interned
+size_t interned = book.interned_ids();
+book.add_limit_order(Side::SELL, 100.0, 100, "MAKER");
+for (int i = 0; i < 100; ++i) {
+    std::string id = "AGG" + std::to_string(i);
+    book.process_market_order(Side::BUY, 1, id);
+    book.submit_order(Side::BUY, OrderType::IOC, 100.0, 1, id, [](const MatchResult&) {});
+}
+EXPECT_EQ(book.interned_ids(), interned + 1);
+}
+
+// Every accepted message and fill takes the next sequence number; rejects take none
+TEST(SequenceTest, MessagesAndFillsAreNumbered) {
+OrderBook<double, PerOrderMapConfig> book;
+uint64_t first = book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+uint64_t second = book.add_limit_order(Side::SELL, 100.0, 100, "S2");
+EXPECT_EQ(first, 1u);
+EXPECT_EQ(second, 2u);
+EXPECT_EQ(book.add_limit_order(Side::SELL, 100.0, 100, "S1"), 0u);
+EXPECT_EQ(book.last_sequence(), 2u);
+
+// Market order is 3, its fills 4 and 5 in match order
+auto fills = book.process_market_order(Side::BUY, 150, "M1");
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_EQ(fills[0].sequence, 4u);
+EXPECT_EQ(fills[0].order_id, first);
+EXPECT_EQ(fills[1].sequence, 5u);
+EXPECT_EQ(fills[1].order_id, second);
+
+EXPECT_TRUE(book.cancel_order("S2"));
+EXPECT_EQ(book.last_sequence(), 6u);
+EXPECT_EQ(book.add_limit_order(Side::BUY, 99.0, 100, "B1"), 7u);
+
+// Zero-quantity market orders are rejected like zero-quantity limits
+EXPECT_TRUE(book.process_market_order(Side::SELL, 0, "M2").empty());
+EXPECT_EQ(book.process_market_order(Side::SELL, 0, "M3", [](const MatchResult&) {}), 0u);
+EXPECT_EQ(book.last_sequence(), 7u);
+EXPECT_EQ(book.add_limit_order(Side::BUY, 98.0, 100, "B2"), 8u);
+}
+
+// Level changes reach L2 subscribers in sequence order
+struct L2FeedConfig : PerOrderMapConfig {
+    static constexpr bool l2_feed = true;
+    static constexpr size_t l2_feed_capacity = 8;
+};
+
+TEST(L2FeedTest, BookChangesArePublished) {
+OrderBook<double, L2FeedConfig> book;
+auto reader = book.l2_feed().reader();
+book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+book.add_limit_order(Side::SELL, 100.0, 50, "S2");
+book.add_limit_order(Side::SELL, 101.0, 70, "S3");
+book.process_market_order(Side::BUY, 160, "M1");
+book.cancel_order("S3");
+
+L2Update update;
+std::vector<L2Update> updates;
+while (reader.poll(update) == OrderBook<double, L2FeedConfig>::L2Feed::ReadStatus::OK) updates.push_back(update);
+ASSERT_EQ(updates.size(), 6u);
+EXPECT_EQ(updates[1].quantity, 150u);
+EXPECT_EQ(updates[1].order_count, 2u);
+EXPECT_EQ(updates[1].sequence, 2u);
+// Sweep removes 100.0 (last fill there is seq 6), then leaves 60 at 101.0 after seq 7
+EXPECT_EQ(updates[3].price, 100.0);
+EXPECT_EQ(updates[3].quantity, 0u);
+EXPECT_EQ(updates[3].sequence, 6u);
+EXPECT_EQ(updates[4].quantity, 60u);
+EXPECT_EQ(updates[4].sequence, 7u);
+EXPECT_EQ(updates[5].side, Side::SELL);
+EXPECT_EQ(updates[5].quantity, 0u);
+EXPECT_EQ(updates[5].sequence, book.last_sequence());
+}
+
+TEST(L2FeedTest, SlowReaderIsLapped) {
+using Ring = BroadcastRing<uint64_t, 8>;
+Ring ring;
+auto reader = ring.reader();
+for (uint64_t i = 0; i < 20; ++i) ring.publish(i);
+
+uint64_t value = 0, lost = 0;
+EXPECT_EQ(reader.poll(value, &lost), Ring::ReadStatus::LAPPED);
+EXPECT_EQ(lost, 13u);
+EXPECT_EQ(reader.poll(value), Ring::ReadStatus::OK);
+EXPECT_EQ(value, 13u);
+while (reader.poll(value) == Ring::ReadStatus::OK) {}
+EXPECT_EQ(value, 19u);
+EXPECT_EQ(reader.poll(value), Ring::ReadStatus::EMPTY);
+}
+
+TEST(ConflatedPublisherTest, SubscribersGetLatestStatePerInterval) {
+using Clock = std::chrono::steady_clock;
+OrderBook<double, L2FeedConfig> book;
+ConflatedPublisher<OrderBook<double, L2FeedConfig>, 16> publisher(book);
+std::vector<L2Update> fast, slow;
+publisher.subscribe([&](const L2Update& update) { fast.push_back(update); });
+publisher.subscribe([&](const L2Update& update) { slow.push_back(update); }, std::chrono::seconds(1));
+
+book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+book.add_limit_order(Side::SELL, 100.0, 50, "S2");
+book.add_limit_order(Side::BUY, 99.0, 70, "B1");
+EXPECT_EQ(publisher.poll(), 3u);
+auto start = Clock::now();
+EXPECT_EQ(publisher.publish(start), 4u);
+ASSERT_EQ(fast.size(), 2u);
+EXPECT_EQ(fast[0].quantity + fast[1].quantity, 220u);
+
+// Three updates to one level conflate to its latest state
+book.process_market_order(Side::BUY, 120, "M1");
+book.cancel_order("B1");
+publisher.poll();
+fast.clear();
+publisher.publish(start + std::chrono::milliseconds(10));
+ASSERT_EQ(fast.size(), 2u);
+EXPECT_EQ(slow.size(), 2u);  // not due yet
+for (const L2Update& update : fast) {
+    if (update.side == Side::SELL) EXPECT_EQ(update.quantity, 30u);
+    else EXPECT_EQ(update.quantity, 0u);
+}
+
+publisher.publish(start + std::chrono::seconds(2));
+ASSERT_EQ(slow.size(), 4u);
+EXPECT_EQ(publisher.tracked_levels(), 1u);  // the removed bid was sent to both
+
+// Falling a full ring behind rebuilds the table from the book
+for (int i = 0; i < 20; ++i) book.add_limit_order(Side::BUY, 90.0 + i * 0.25, 10, "B" + std::to_string(i + 2));
+publisher.poll();
+EXPECT_GT(publisher.lost(), 0u);
+EXPECT_EQ(publisher.tracked_levels(), 16u);
+EXPECT_EQ(publisher.dropped(), 1u);  // 16 bids read back, 15 slots left after the ask
+}
+
+struct L3FeedConfig : PerOrderMapConfig {
+    static constexpr bool l3_feed = true;
+};
+
+TEST(L3FeedTest, SnapshotPlusUpdatesRebuildsTheBook) {
+OrderBook<double, L3FeedConfig> book;
+book.add_limit_order(Side::SELL, 100.0, 100, "S1");
+book.add_limit_order(Side::SELL, 100.5, 50, "S2");
+book.add_limit_order(Side::BUY, 99.0, 70, "B1");
+
+// Late joiner: reader first, then the snapshot
+auto reader = book.l3_feed().reader();
+std::map<uint64_t, uint32_t> orders;
+uint64_t as_of = book.l3_snapshot([&](const RestingOrder& order) { orders[order.order_id] = order.quantity; });
+EXPECT_EQ(as_of, 3u);
+EXPECT_EQ(orders.size(), 3u);
+
+book.add_limit_order(Side::BUY, 98.0, 40, "B2");
+book.process_market_order(Side::BUY, 120, "M1");
+EXPECT_TRUE(book.modify_order(book.intern_id("B1"), 30));
+EXPECT_FALSE(book.modify_order(book.intern_id("B1"), 30));
+EXPECT_TRUE(book.cancel_order("B2"));
+
+L3Update update;
+std::vector<L3Action> actions;
+while (reader.poll(update) == OrderBook<double, L3FeedConfig>::L3Feed::ReadStatus::OK) {
+    if (update.sequence <= as_of) continue;
+    actions.push_back(update.action);
+    switch (update.action) {
+        case L3Action::ADD: orders[update.order_id] = update.quantity; break;
+        case L3Action::MODIFY: orders[update.order_id] = update.quantity; break;
+        case L3Action::DELETE: orders.erase(update.order_id); break;
+        case L3Action::EXECUTE:
+            if ((orders[update.order_id] -= update.quantity) == 0) orders.erase(update.order_id);
+            break;
+    }
+}
+EXPECT_EQ(actions, (std::vector<L3Action>{L3Action::ADD, L3Action::EXECUTE, L3Action::EXECUTE,
+                                          L3Action::MODIFY, L3Action::DELETE}));
+
+std::map<uint64_t, uint32_t> expected;
+book.l3_snapshot([&](const RestingOrder& order) { expected[order.order_id] = order.quantity; });
+EXPECT_EQ(orders, expected);
+EXPECT_EQ(expected.size(), 2u);
+
+// The visitor runs after the lock is released, so it may act on the book itself
+size_t visited = 0;
+book.l3_snapshot([&](const RestingOrder& order) {
+    ++visited;
+    EXPECT_TRUE(book.cancel_order(order.id));
+});
+EXPECT_EQ(visited, 2u);
+EXPECT_EQ(book.resting_orders(), 0u);
+}
+
+// Snapshots taken while orders arrive each see a whole book as of their sequence number
+TEST(L3FeedTest, ConcurrentSnapshotsAreConsistent) {
+OrderBook<double, L3FeedConfig> book;
+std::atomic<bool> done{false};
+std::atomic<uint64_t> bad{0};
+
+std::thread analytics([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+        uint64_t count = 0;
+        uint64_t as_of = book.l3_snapshot([&](const RestingOrder& order) {
+            // Bids of 10 from 100 down, one per accepted order
+            if (order.price != 100.0 - static_cast<double>(count) || order.order_id != count + 1) bad.fetch_add(1);
+            ++count;
+        });
+        if (count != as_of) bad.fetch_add(1);
+    }
+});
+for (int i = 0; i < 500; ++i) book.add_limit_order(Side::BUY, 100.0 - i, 10, "B" + std::to_string(i));
+done.store(true);
+analytics.join();
+
+EXPECT_EQ(bad.load(), 0u);
+size_t visited = 0;
+EXPECT_EQ(book.l3_snapshot([&](const RestingOrder&) { ++visited; }), 500u);
+EXPECT_EQ(visited, 500u);
+}
+
+// More snapshots at once than there are reader slots fall back to private copies instead
+// of waiting: every thread stays inside its visitor until all of them have arrived
+TEST(L3FeedTest, SnapshotsBeyondReaderSlotsDoNotWait) {
+OrderBook<double, L3FeedConfig> book;
+for (int i = 0; i < 5; ++i) book.add_limit_order(Side::BUY, 100.0 - i, 10, "B" + std::to_string(i));
+
+constexpr size_t threads = L3FeedConfig::l3_view_readers + 8;
+std::latch inside(threads);
+std::atomic<uint64_t> visited{0};
+std::vector<std::thread> analytics;
+for (size_t t = 0; t < threads; ++t) {
+    analytics.emplace_back([&] {
+        bool first = true;
+        EXPECT_EQ(book.l3_snapshot([&](const RestingOrder&) {
+            if (std::exchange(first, false)) inside.arrive_and_wait();
+            visited.fetch_add(1);
+        }), 5u);
+    });
+}
+for (auto& thread : analytics) thread.join();
+EXPECT_EQ(visited.load(), threads * 5);
+}
+
+// A visitor may take snapshots of its own, nested past the reader slots
+TEST(L3FeedTest, NestedSnapshotsBeyondReaderSlots) {
+OrderBook<double, L3FeedConfig> book;
+book.add_limit_order(Side::BUY, 100.0, 10, "B1");
+book.add_limit_order(Side::SELL, 101.0, 10, "S1");
+
+constexpr size_t depth = L3FeedConfig::l3_view_readers + 4;
+size_t deepest = 0;
+std::function<void(size_t)> nest = [&](size_t level) {
+    deepest = std::max(deepest, level);
+    size_t seen = 0;
+    EXPECT_EQ(book.l3_snapshot([&](const RestingOrder&) {
+        if (seen++ == 0 && level < depth) nest(level + 1);
+    }), 2u);
+    EXPECT_EQ(seen, 2u);
+};
+nest(1);
+EXPECT_EQ(deepest, depth);
+}
+
+// A crossing limit's rested remainder is published after its fills, with a fresh sequence
+TEST(L3FeedTest, RestAfterFillsKeepsSequencesIncreasing) {
+OrderBook<double, L3FeedConfig> book;
+auto reader = book.l3_feed().reader();
+book.add_limit_order(Side::SELL, 100.0, 50, "S1");
+OrderResult result = book.submit_order(Side::BUY, OrderType::LIMIT, 100.0, 80, "B1", [](const MatchResult&) {});
+EXPECT_EQ(result.order_id, 2u);
+EXPECT_EQ(result.resting, 30u);
+
+L3Update update;
+std::vector<L3Update> updates;
+while (reader.poll(update) == OrderBook<double, L3FeedConfig>::L3Feed::ReadStatus::OK) updates.push_back(update);
+ASSERT_EQ(updates.size(), 3u);
+EXPECT_EQ(updates[1].action, L3Action::EXECUTE);
+EXPECT_EQ(updates[1].sequence, 3u);
+EXPECT_EQ(updates[2].action, L3Action::ADD);
+EXPECT_EQ(updates[2].order_id, 2u);
+EXPECT_EQ(updates[2].sequence, 4u);
+EXPECT_EQ(book.last_sequence(), 4u);
+}
+
+struct DepthViewConfig : SmallQueueConfig {
+    static constexpr bool depth_views = true;
+};
+
+TEST(DepthViewTest, ReadersWalkPublishedViewsWithoutTheLock) {
+OrderBook<double, DepthViewConfig> book;
+EXPECT_EQ(book.depth_view(), nullptr);
+std::atomic<bool> done{false};
+std::atomic<uint64_t> bad{0};
+
+std::thread analytics([&] {
+    auto reader = book.depth_reader();
+    while (!done.load(std::memory_order_relaxed)) {
+        auto guard = reader.pin();
+        const DepthView* view = book.depth_view();
+        if (!view) continue;
+        // Every view is a whole book: n bids of 10 at 100, 99, ...
+        for (size_t i = 0; i < view->bids.size(); ++i) {
+            if (view->bids[i].price != 100.0 - static_cast<double>(i) || view->bids[i].total_quantity != 10) bad.fetch_add(1);
+        }
+        if (view->bids.size() != view->sequence) bad.fetch_add(1);
+    }
+});
+for (int i = 0; i < 200; ++i) {
+    book.add_limit_order(Side::BUY, 100.0 - i, 10, "B");
+    EXPECT_EQ(book.publish_depth_view(), static_cast<uint64_t>(i + 1));
+}
+done.store(true);
+analytics.join();
+
+EXPECT_EQ(bad.load(), 0u);
+auto reader = book.depth_reader();
+auto guard = reader.pin();
+EXPECT_EQ(book.depth_view()->bids.size(), 200u);
+EXPECT_TRUE(book.depth_view()->asks.empty());
+}
+
+// Concurrent adds through the flat-combining front end all land exactly once
+struct CombiningConfig : DefaultBookConfig {
+    static constexpr size_t queue_capacity = 1024;
+    static constexpr bool flat_combining = true;
+    static constexpr size_t combining_slots = 8;
+};
+
+TEST(FlatCombiningTest, ConcurrentAddsAreApplied) {
+OrderBook<double, CombiningConfig> book;
+constexpr size_t THREADS = 16;
+constexpr size_t ORDERS = 2000;
+
+std::vector<std::thread> threads;
+for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&book, t] {
+        for (size_t i = 0; i < ORDERS; ++i) {
+            book.add_limit_order(t % 2 ? Side::SELL : Side::BUY, t % 2 ? 101.0 : 100.0, 1, "FC");
+        }
+    });
+}
+for (auto& thread : threads) thread.join();
+
+auto bids = book.get_depth(Side::BUY, 1);
+auto asks = book.get_depth(Side::SELL, 1);
+ASSERT_EQ(bids.size(), 1u);
+ASSERT_EQ(asks.size(), 1u);
+EXPECT_EQ(bids[0].total_quantity, THREADS / 2 * ORDERS);
+EXPECT_EQ(bids[0].order_count, THREADS / 2 * ORDERS);
+EXPECT_EQ(asks[0].total_quantity, THREADS / 2 * ORDERS);
+}
+
+// SoA ladder books: combined adds update the store's arrays in place, prices off the band
+// are rejected, and matching takes straight from the ladder
+struct SoaCombiningConfig : CombiningConfig {
+    static constexpr LevelStorage level_storage = LevelStorage::SOA_LADDER;
+    static constexpr double ladder_base_price = 90.0;
+    static constexpr bool l2_feed = true;
+    static constexpr size_t l2_feed_capacity = 1 << 16;
+};
+
+TEST(SoaLadderTest, BatchedAddsAndOffBandPrices) {
+OrderBook<double, SoaCombiningConfig> book;
+EXPECT_EQ(book.add_limit_order(Side::BUY, 89.99, 10, "X"), 0u);
+EXPECT_EQ(book.add_limit_order(Side::SELL, 130.96, 10, "X"), 0u);
+EXPECT_EQ(book.submit_order(Side::BUY, OrderType::LIMIT, 89.0, 10, "X", [](const MatchResult&) {}).order_id, 0u);
+EXPECT_EQ(book.last_sequence(), 0u);
+
+// Threads close together share delta windows; the 95.00 / 99.00 pair spans too many ticks
+constexpr size_t THREADS = 8;
+constexpr size_t ORDERS = 500;
+std::vector<std::thread> threads;
+for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&book, t] {
+        const double price = t == 0 ? 95.0 : 99.0 - 0.01 * static_cast<double>(t % 4);
+        const Side side = t < 4 ? Side::BUY : Side::SELL;
+        for (size_t i = 0; i < ORDERS; ++i) {
+            book.add_limit_order(side, side == Side::BUY ? price : price + 2.0, 1, "SOA");
+        }
+    });
+}
+for (auto& thread : threads) thread.join();
+EXPECT_EQ(book.last_sequence(), THREADS * ORDERS);
+
+auto bids = book.get_depth(Side::BUY, 10);
+ASSERT_EQ(bids.size(), 4u);
+EXPECT_DOUBLE_EQ(bids[0].price, 98.99);
+EXPECT_EQ(bids[3].price, 95.0);
+EXPECT_EQ(bids[3].order_count, ORDERS);
+auto asks = book.get_depth(Side::SELL, 10);
+ASSERT_EQ(asks.size(), 4u);
+EXPECT_DOUBLE_EQ(asks[0].price, 100.97);
+EXPECT_EQ(asks[3].total_quantity, ORDERS);
+
+// A sweep through three bid levels; the last one is left partly filled
+std::vector<MatchResult> fills;
+EXPECT_EQ(book.process_market_order(Side::SELL, 2 * ORDERS + 10, "M",
+                                    [&](const MatchResult& m) { fills.push_back(m); }), 2 * ORDERS + 10);
+ASSERT_EQ(fills.size(), 3u);
+EXPECT_DOUBLE_EQ(fills[2].price, 98.97);
+EXPECT_EQ(fills[2].quantity, 10u);
+EXPECT_DOUBLE_EQ(book.get_best_prices().first, 98.97);
+EXPECT_EQ(book.get_depth(Side::BUY, 1)[0].total_quantity, ORDERS - 10);
+
+// A limited sweep stops at its price and publishes each level it touched
+auto reader = book.l2_feed().reader();
+OrderResult ioc = book.submit_order(Side::BUY, OrderType::IOC, 100.98, 3 * ORDERS, "I",
+                                    [](const MatchResult&) {});
+EXPECT_EQ(ioc.filled, 2 * ORDERS);
+EXPECT_DOUBLE_EQ(book.get_best_prices().second, 100.99);
+L2Update update;
+std::vector<L2Update> updates;
+while (reader.poll(update) == OrderBook<double, SoaCombiningConfig>::L2Feed::ReadStatus::OK) updates.push_back(update);
+ASSERT_EQ(updates.size(), 2u);
+EXPECT_EQ(updates[1].quantity, 0u);
+EXPECT_EQ(updates[1].sequence, book.last_sequence());
+}
+
+// Tick-indexed books reject prices between ticks instead of filing them under the nearest
+// level, where a buy would rest above its limit and cross the book
+template<typename Config>
+void expect_off_tick_rejected() {
+    OrderBook<double, Config> book;
+    auto ignore = [](const MatchResult&) {};
+    ASSERT_TRUE(book.add_limit_order(Side::SELL, 100.01, 100, "S1"));
+    EXPECT_EQ(book.add_limit_order(Side::BUY, 100.006, 100, "B1"), 0u);
+    EXPECT_EQ(book.submit_order(Side::BUY, OrderType::LIMIT, 100.006, 100, "B2", ignore).order_id, 0u);
+    EXPECT_EQ(book.submit_order(Side::BUY, OrderType::POST_ONLY, 99.994, 100, "B3", ignore).order_id, 0u);
+    EXPECT_EQ(book.last_sequence(), 1u);
+    auto [bid, ask] = book.get_best_prices();
+    EXPECT_EQ(bid, 0.0);
+    EXPECT_DOUBLE_EQ(ask, 100.01);
+
+    // An IOC never rests, so its limit only bounds the match
+    OrderResult ioc = book.submit_order(Side::BUY, OrderType::IOC, 100.006, 100, "I1", ignore);
+    EXPECT_NE(ioc.order_id, 0u);
+    EXPECT_EQ(ioc.filled, 0u);
+    EXPECT_TRUE(book.add_limit_order(Side::BUY, 100.0, 100, "B4"));
+}
+
+TEST(TickLadderTest, OffTickPricesAreRejected) {
+expect_off_tick_rejected<SpinLadderConfig>();
+expect_off_tick_rejected<SoaLadderConfig>();
+}
+
+// Every spinning lock must exclude concurrent holders, including under oversubscription
+template<typename L>
+class LockTest : public ::testing::Test {};
+
+using SpinningLocks = ::testing::Types<SpinLock, TicketLock, McsLock>;
+TYPED_TEST_SUITE(LockTest, SpinningLocks);
+
+TYPED_TEST(LockTest, MutualExclusion) {
+TypeParam lock;
+TypeParam inner;
+uint64_t counter = 0;
+uint64_t nested = 0;
+constexpr int THREADS = 8;
+constexpr int ITERATIONS = 5000;
+
+std::vector<std::thread> threads;
+for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&] {
+        for (int i = 0; i < ITERATIONS; ++i) {
+            std::unique_lock guard(lock);
+            ++counter;
+            if (i % 16 == 0) {
+                std::unique_lock inner_guard(inner);
+                ++nested;
+            }
+        }
+    });
+}
+for (auto& thread : threads) thread.join();
+
+EXPECT_EQ(counter, uint64_t{THREADS} * ITERATIONS);
+EXPECT_EQ(nested, uint64_t{THREADS} * ((ITERATIONS + 15) / 16));
+EXPECT_TRUE(lock.try_lock());
+EXPECT_FALSE(lock.try_lock());
+lock.unlock();
+}
+
+// Past its per-thread pool of queue nodes an MCS holder takes nodes from the heap
+TEST(McsLockTest, NestsBeyondThePool) {
+std::vector<McsLock> locks(McsLock::MAX_HELD + 8);
+for (auto& lock : locks) lock.lock();
+std::thread other([&] {
+    for (auto& lock : locks) EXPECT_FALSE(lock.try_lock());
+});
+other.join();
+for (auto it = locks.rbegin(); it != locks.rend(); ++it) it->unlock();
+for (auto& lock : locks) {
+    ASSERT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+}
+
+TEST(EpochTest, RetiredObjectsOutlivePinnedReaders) {
+EpochDomain<4> domain;
+auto reader = domain.register_reader();
+int freed = 0;
+auto count_free = [](void* p) { ++*static_cast<int*>(p); };
+
+domain.retire(&freed, count_free);
+{
+    auto guard = reader.pin();
+    domain.retire(&freed, count_free);
+    EXPECT_EQ(domain.reclaim(), 1u);  // retired before the pin
+    EXPECT_EQ(domain.reclaim(), 0u);
+}
+EXPECT_EQ(domain.reclaim(), 1u);
+EXPECT_EQ(freed, 2);
+}
+
+TEST(EpochTest, ConcurrentReadersNeverSeeFreedNodes) {
+struct Node {
+    uint64_t value;
+    ~Node() { value = 0; }
+};
+EpochDomain<8> domain;
+std::atomic<Node*> current{new Node{1}};
+std::atomic<bool> done{false};
+std::atomic<uint64_t> bad{0};
+
+std::vector<std::thread> readers;
+for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&] {
+        auto reader = domain.register_reader();
+        while (!done.load(std::memory_order_relaxed)) {
+            auto guard = reader.pin();
+            if (current.load(std::memory_order_acquire)->value == 0) bad.fetch_add(1);
+        }
+    });
+}
+for (uint64_t i = 2; i < 20000; ++i) {
+    Node* old = current.exchange(new Node{i}, std::memory_order_acq_rel);
+    domain.retire(old);
+}
+done.store(true);
+for (auto& thread : readers) thread.join();
+domain.reclaim();
+
+EXPECT_EQ(bad.load(), 0u);
+EXPECT_EQ(domain.pending(), 0u);
+delete current.load();
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
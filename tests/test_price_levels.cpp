@@ -0,0 +1,402 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <functional>
+#include <map>
+
+#include "../include/price_level_store.h"
+#include "../include/node_pool.h"
+#include "../include/hybrid_levels.h"
+#include "../include/bplus_tree.h"
+#include "../include/level_bitmap.h"
+#include "../include/allocation.h"
+
+class PriceLevelStoreTest : public ::testing::Test {
+protected:
+    // 100.00 .. 100.99 in one-cent ticks
+    PriceLevelStore<double> store{100.0, 0.01, 100};
+};
+
+TEST_F(PriceLevelStoreTest, LevelIdMapping) {
+EXPECT_EQ(store.level_id(100.0), 0u);
+EXPECT_EQ(store.level_id(100.25), 25u);
+EXPECT_EQ(store.level_id(99.99), PriceLevelStore<double>::NO_LEVEL);
+EXPECT_EQ(store.level_id(101.0), PriceLevelStore<double>::NO_LEVEL);
+EXPECT_EQ(store.level_id(100.006), PriceLevelStore<double>::NO_LEVEL);
+EXPECT_DOUBLE_EQ(store.price(25), 100.25);
+}
+
+TEST_F(PriceLevelStoreTest, ContiguousAndScatteredUpdates) {
+std::vector<int32_t> deltas(11);
+std::iota(deltas.begin(), deltas.end(), 1);
+store.apply_contiguous_updates(10, deltas.data(), deltas.size());
+
+std::vector<uint32_t> ids{10, 50};
+std::vector<int32_t> more{5, 7};
+store.apply_updates(ids.data(), more.data(), ids.size());
+
+EXPECT_EQ(store.quantity(10), 6u);
+EXPECT_EQ(store.count(10), 2u);
+EXPECT_EQ(store.quantity(20), 11u);
+EXPECT_EQ(store.count(20), 1u);
+EXPECT_EQ(store.quantity(50), 7u);
+EXPECT_EQ(store.quantity(21), 0u);
+
+// A sparse window: only the levels with a nonzero count delta gain orders
+std::vector<int32_t> window_quantities(7, 0), window_counts(7, 0);
+window_quantities[0] = 4;
+window_counts[0] = 2;
+window_quantities[6] = 9;
+window_counts[6] = 1;
+store.apply_window_updates(60, window_quantities.data(), window_counts.data(), window_quantities.size());
+EXPECT_EQ(store.quantity(60), 4u);
+EXPECT_EQ(store.count(60), 2u);
+EXPECT_EQ(store.quantity(63), 0u);
+EXPECT_EQ(store.quantity(66), 9u);
+EXPECT_EQ(store.next_level(Side::SELL, 60), 66u);
+EXPECT_EQ(store.occupied_levels(), 14u);
+}
+
+TEST_F(PriceLevelStoreTest, LiquidityScans) {
+for (size_t id = 0; id < store.size(); ++id) {
+    store.update(id, static_cast<int32_t>(id), 1);
+}
+
+// Asks from 100.10 up to 100.20: 10 + 11 + ... + 20
+EXPECT_EQ(store.liquidity_up_to(Side::SELL, 10, 100.20), 165u);
+// Bids from 100.20 down to 100.10
+EXPECT_EQ(store.liquidity_up_to(Side::BUY, 20, 100.10), 165u);
+// Limit beyond the best in the wrong direction
+EXPECT_EQ(store.liquidity_up_to(Side::SELL, 10, 100.05), 0u);
+// Limit past the end of the ladder takes everything
+EXPECT_EQ(store.liquidity_up_to(Side::SELL, 90, 200.0), 945u);
+
+EXPECT_EQ(store.first_level_with_quantity(Side::SELL, 3, 42), 42u);
+EXPECT_EQ(store.first_level_with_quantity(Side::BUY, 80, 500), PriceLevelStore<double>::NO_LEVEL);
+store.update(5, 1000, 1);
+store.update(7, 1000, 1);
+EXPECT_EQ(store.first_level_with_quantity(Side::BUY, 80, 500), 7u);
+EXPECT_EQ(store.first_level_with_quantity(Side::SELL, 0, 500), 5u);
+}
+
+TEST(SimdScanTest, MatchesScalar) {
+std::vector<uint32_t> values(37);
+for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<uint32_t>((i * 7919) % 101);
+values[3] = 0xFFFFFFF0u;  // exercises the unsigned compare and 64-bit widening
+
+uint64_t expected = std::accumulate(values.begin(), values.end(), uint64_t{0});
+EXPECT_EQ(SimdScan::sum(values.data(), values.size()), expected);
+
+for (uint32_t threshold : {0u, 50u, 100u, 0x80000000u, 0xFFFFFFFFu}) {
+    size_t first = values.size();
+    size_t last = values.size();
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] >= threshold) {
+            if (first == values.size()) first = i;
+            last = i;
+        }
+    }
+    EXPECT_EQ(SimdScan::find_first_at_least(values.data(), values.size(), threshold), first);
+    EXPECT_EQ(SimdScan::find_last_at_least(values.data(), values.size(), threshold), last);
+}
+
+std::vector<uint64_t> running(values.size());
+SimdScan::inclusive_scan(values.data(), running.data(), values.size());
+uint64_t total = 0;
+for (size_t i = 0; i < values.size(); ++i) {
+    total += values[i];
+    EXPECT_EQ(running[i], total);
+}
+}
+
+TEST(ProRataTest, SharesMatchIntegerDivision) {
+std::mt19937 gen(11);
+for (int trial = 0; trial < 200; ++trial) {
+    std::vector<uint32_t> quantities(gen() % 64 + 1);
+    uint64_t total = 0;
+    for (auto& quantity : quantities) {
+        quantity = trial % 2 ? gen() % 1000 + 1 : gen() % 60'000'000;
+        total += quantity;
+    }
+    if (total == 0 || total > UINT32_MAX) continue;
+    uint32_t fill = static_cast<uint32_t>(gen() % total);
+    std::vector<uint32_t> shares(quantities.size());
+    ProRata::shares(quantities.data(), quantities.size(), fill, static_cast<uint32_t>(total), shares.data());
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        EXPECT_EQ(shares[i], static_cast<uint64_t>(fill) * quantities[i] / total);
+    }
+}
+}
+
+TEST_F(PriceLevelStoreTest, SweepAsksAcrossLevels) {
+// 100 lots on every other level from 100.10
+for (size_t id = 10; id < 60; id += 2) store.update(static_cast<size_t>(id), 100, 1);
+
+IdHandle aggressor = 42;
+std::vector<MatchResult> fills;
+uint32_t remaining = store.sweep(Side::SELL, 10, 2050, aggressor, fills);
+
+EXPECT_EQ(remaining, 0u);
+ASSERT_EQ(fills.size(), 21u);
+EXPECT_DOUBLE_EQ(fills.front().price, 100.10);
+EXPECT_EQ(fills.front().quantity, 100u);
+EXPECT_DOUBLE_EQ(fills.back().price, 100.50);
+EXPECT_EQ(fills.back().quantity, 50u);
+EXPECT_EQ(fills.back().counterparty_id, 42u);
+
+EXPECT_EQ(store.quantity(48), 0u);
+EXPECT_EQ(store.count(48), 0u);
+EXPECT_EQ(store.quantity(50), 50u);
+EXPECT_EQ(store.count(50), 1u);
+EXPECT_EQ(store.quantity(52), 100u);
+}
+
+TEST_F(PriceLevelStoreTest, SweepBidsExhaustsBook) {
+store.update(40, 300, 2);
+store.update(5, 200, 1);
+
+IdHandle aggressor = 0;
+std::vector<MatchResult> fills;
+uint32_t remaining = store.sweep(Side::BUY, 40, 800, aggressor, fills);
+
+EXPECT_EQ(remaining, 300u);
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_DOUBLE_EQ(fills[0].price, 100.40);
+EXPECT_EQ(fills[0].quantity, 300u);
+EXPECT_DOUBLE_EQ(fills[1].price, 100.05);
+EXPECT_EQ(fills[1].quantity, 200u);
+EXPECT_EQ(store.total_quantity(0, store.size() - 1), 0u);
+EXPECT_EQ(store.count(40), 0u);
+}
+
+TEST_F(PriceLevelStoreTest, SweepStopsAtTheLimitLevel) {
+store.update(40, 300, 2);
+store.update(20, 100, 1);
+store.update(5, 200, 1);
+
+// A sell limited at 100.195 reaches the bids down to 100.20
+size_t bound = store.limit_level(Side::BUY, 40, 100.195);
+EXPECT_EQ(bound, 20u);
+EXPECT_EQ(store.limit_level(Side::BUY, 40, 100.41), PriceLevelStore<double>::NO_LEVEL);
+EXPECT_EQ(store.liquidity_up_to(Side::BUY, 40, 100.195), 400u);
+
+std::vector<MatchResult> fills;
+EXPECT_EQ(store.sweep(Side::BUY, 40, bound, 450, 0, fills), 50u);
+ASSERT_EQ(fills.size(), 2u);
+EXPECT_DOUBLE_EQ(fills[1].price, 100.20);
+EXPECT_EQ(store.quantity(5), 200u);
+EXPECT_EQ(store.best_level(Side::BUY), 5u);
+
+// An ask sweep with the limit inside the remaining quantity leaves the last level partial
+store.update(60, 100, 1);
+store.update(70, 100, 1);
+fills.clear();
+EXPECT_EQ(store.sweep(Side::SELL, 60, store.limit_level(Side::SELL, 60, 100.70), 150, 0, fills), 0u);
+EXPECT_EQ(store.quantity(70), 50u);
+}
+
+TEST_F(PriceLevelStoreTest, BestAndNextLevelTrackSweeps) {
+EXPECT_EQ(store.best_level(Side::SELL), PriceLevelStore<double>::NO_LEVEL);
+store.update(12, 100, 1);
+store.update(30, 100, 1);
+store.update(75, 100, 1);
+
+EXPECT_EQ(store.best_level(Side::SELL), 12u);
+EXPECT_EQ(store.next_level(Side::SELL, 12), 30u);
+EXPECT_EQ(store.best_level(Side::BUY), 75u);
+EXPECT_EQ(store.next_level(Side::BUY, 75), 30u);
+EXPECT_EQ(store.next_level(Side::BUY, 12), PriceLevelStore<double>::NO_LEVEL);
+
+IdHandle aggressor = 0;
+std::vector<MatchResult> fills;
+store.sweep(Side::SELL, store.best_level(Side::SELL), 150, aggressor, fills);
+EXPECT_EQ(store.best_level(Side::SELL), 30u);
+store.update(30, -50, -1);
+EXPECT_EQ(store.best_level(Side::SELL), 75u);
+}
+
+TEST(LevelBitmapTest, MatchesLinearScan) {
+// Three summary levels; probe around word and summary boundaries
+const size_t size = 300000;
+LevelBitmap bitmap(size);
+std::vector<bool> reference(size, false);
+std::mt19937 rng(7);
+std::uniform_int_distribution<size_t> pick(0, size - 1);
+
+for (int i = 0; i < 2000; ++i) {
+    size_t tick = pick(rng);
+    bitmap.set(tick);
+    reference[tick] = true;
+}
+for (size_t tick : {0ul, 63ul, 64ul, 4095ul, 4096ul, 262143ul, 262144ul, size - 1}) {
+    bitmap.set(tick);
+    reference[tick] = true;
+}
+bitmap.clear_range(1000, 90000);
+std::fill(reference.begin() + 1000, reference.begin() + 90001, false);
+for (int i = 0; i < 500; ++i) {
+    size_t tick = pick(rng);
+    bitmap.clear(tick);
+    reference[tick] = false;
+}
+
+auto next_ref = [&](size_t i) {
+    for (; i < size; ++i) if (reference[i]) return i;
+    return LevelBitmap::NPOS;
+};
+auto prev_ref = [&](size_t i) {
+    for (size_t j = i + 1; j-- > 0;) if (reference[j]) return j;
+    return LevelBitmap::NPOS;
+};
+
+for (int i = 0; i < 2000; ++i) {
+    size_t probe = pick(rng);
+    ASSERT_EQ(bitmap.next_set(probe), next_ref(probe)) << probe;
+    ASSERT_EQ(bitmap.prev_set(probe), prev_ref(probe)) << probe;
+    ASSERT_EQ(bitmap.test(probe), reference[probe]);
+}
+EXPECT_EQ(bitmap.first(), next_ref(0));
+EXPECT_EQ(bitmap.last(), prev_ref(size - 1));
+
+bitmap.reset();
+EXPECT_FALSE(bitmap.any());
+EXPECT_EQ(bitmap.first(), LevelBitmap::NPOS);
+}
+
+TEST(NodePoolTest, RecyclesBlocksAndGrows) {
+NodePool pool(4, 64, 4);
+EXPECT_EQ(pool.capacity(), 4u);
+
+std::vector<void*> blocks;
+for (int i = 0; i < 6; ++i) blocks.push_back(pool.allocate(48, 8));
+EXPECT_EQ(pool.blocks_in_use(), 6u);
+EXPECT_EQ(pool.capacity(), 8u);
+
+void* last = blocks.back();
+pool.deallocate(last, 48, 8);
+EXPECT_EQ(pool.allocate(48, 8), last);
+
+// Oversized requests bypass the slab
+void* big = pool.allocate(1024, 8);
+EXPECT_EQ(pool.blocks_in_use(), 6u);
+pool.deallocate(big, 1024, 8);
+
+for (void* block : blocks) pool.deallocate(block, 48, 8);
+EXPECT_EQ(pool.blocks_in_use(), 0u);
+}
+
+TEST(NodePoolTest, BacksPmrMap) {
+NodePool pool(16);
+std::pmr::map<double, PriceLevel> levels{&pool};
+for (int i = 0; i < 100; ++i) levels.try_emplace(100.0 + i, PriceLevel{10, 1});
+EXPECT_EQ(pool.blocks_in_use(), 100u);
+levels.clear();
+EXPECT_EQ(pool.blocks_in_use(), 0u);
+}
+
+TEST(NodePoolTest, BacksBPlusTree) {
+using Tree = BTreeLevels<double, Side::SELL>;
+NodePool pool(64, Tree::NODE_SIZE, 64, Tree::NODE_ALIGN);
+{
+    Tree tree{&pool};
+    for (int i = 0; i < 1000; ++i) tree.find_or_insert(100.0 + i * 0.01).total_quantity = 10;
+    EXPECT_GT(pool.blocks_in_use(), 1000u / 16);  // every node came from the slab
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(tree.erase(100.0 + i * 0.01));
+    EXPECT_EQ(pool.blocks_in_use(), 1u);  // the empty root leaf
+}
+EXPECT_EQ(pool.blocks_in_use(), 0u);
+}
+
+TEST(HybridLevelsTest, WindowAndOutliers) {
+HybridLevels<double, Side::SELL> asks(0.01, 64);
+asks.find_or_insert(100.00).total_quantity = 100;
+asks.find_or_insert(100.05).total_quantity = 200;
+asks.find_or_insert(250.00).total_quantity = 1;  // fat-finger ask far from the touch
+
+EXPECT_EQ(asks.size(), 3u);
+EXPECT_EQ(asks.window_levels(), 2u);
+EXPECT_EQ(asks.outlier_levels(), 1u);
+ASSERT_NE(asks.find(250.00), nullptr);
+EXPECT_EQ(asks.find(100.01), nullptr);
+
+double price = 0;
+ASSERT_NE(asks.best(price), nullptr);
+EXPECT_DOUBLE_EQ(price, 100.00);
+
+std::vector<double> order;
+asks.for_each([&](double p, const PriceLevel&) { order.push_back(p); return true; });
+ASSERT_EQ(order.size(), 3u);
+EXPECT_DOUBLE_EQ(order[0], 100.00);
+EXPECT_DOUBLE_EQ(order[1], 100.05);
+EXPECT_DOUBLE_EQ(order[2], 250.00);
+}
+
+TEST(HybridLevelsTest, RecentersAsTouchMoves) {
+HybridLevels<double, Side::BUY> bids(0.01, 64);
+for (int i = 0; i < 60; ++i) {
+    bids.find_or_insert(100.00 - i * 0.01).total_quantity = 10;
+}
+// Window holds 48 ticks below the anchor; the deepest bids spill into outliers
+EXPECT_GT(bids.outlier_levels(), 0u);
+size_t total = bids.size();
+
+// Empty the top of book: the touch drifts past the middle and the window follows it
+for (int i = 0; i < 40; ++i) bids.erase(100.00 - i * 0.01);
+double price = 0;
+ASSERT_NE(bids.best(price), nullptr);
+EXPECT_DOUBLE_EQ(price, 99.60);
+EXPECT_EQ(bids.size(), total - 40);
+EXPECT_EQ(bids.outlier_levels(), 0u);
+
+// A better bid outside the window moves it back to the new touch
+bids.find_or_insert(105.00).total_quantity = 5;
+ASSERT_NE(bids.best(price), nullptr);
+EXPECT_DOUBLE_EQ(price, 105.00);
+
+std::vector<double> order;
+bids.for_each([&](double p, const PriceLevel&) { order.push_back(p); return true; });
+ASSERT_EQ(order.size(), bids.size());
+EXPECT_TRUE(std::is_sorted(order.begin(), order.end(), std::greater<>()));
+}
+
+TEST(BPlusTreeTest, MatchesStdMapUnderRandomChurn) {
+BTreeLevels<double, Side::BUY> tree;
+std::map<double, PriceLevel, std::greater<>> reference;
+std::mt19937 gen(1234);
+std::uniform_int_distribution<int> tick_dist(0, 2000);
+
+for (int i = 0; i < 20000; ++i) {
+    double price = 50.0 + tick_dist(gen) * 0.01;
+    if (gen() % 3 == 0) {
+        EXPECT_EQ(tree.erase(price), reference.erase(price) == 1);
+    } else {
+        auto [level, inserted] = tree.try_emplace(price, PriceLevel{static_cast<uint32_t>(i), 1});
+        auto [it, ref_inserted] = reference.try_emplace(price, PriceLevel{static_cast<uint32_t>(i), 1});
+        EXPECT_EQ(inserted, ref_inserted);
+        EXPECT_EQ(level->total_quantity, it->second.total_quantity);
+    }
+}
+
+ASSERT_EQ(tree.size(), reference.size());
+auto ref = reference.begin();
+for (auto it = tree.begin(); it != tree.end(); ++it, ++ref) {
+    ASSERT_EQ(it.key(), ref->first);
+    EXPECT_EQ(it.value().total_quantity, ref->second.total_quantity);
+}
+
+double best = 0;
+ASSERT_NE(tree.best(best), nullptr);
+EXPECT_EQ(best, reference.begin()->first);
+
+auto lb = tree.lower_bound(60.005);
+EXPECT_EQ(lb.key(), reference.lower_bound(60.005)->first);
+
+// Drain completely, then reuse
+for (const auto& [price, level] : reference) EXPECT_TRUE(tree.erase(price));
+EXPECT_TRUE(tree.empty());
+EXPECT_EQ(tree.begin(), tree.end());
+tree.find_or_insert(42.0).total_quantity = 7;
+ASSERT_NE(tree.find(42.0), nullptr);
+EXPECT_EQ(tree.find(42.0)->total_quantity, 7u);
+}